@@ -0,0 +1,130 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Profile.h"
+
+// Hands items from any thread to a single worker thread, which processes them one at a time in the order they came.
+// The worker starts with the queue and stops with it: the items still queued then are processed first if drain is set,
+// otherwise dropped. Members an owner's process touches have to be declared before the queue, so they outlive the worker.
+template<typename T>
+class BackgroundQueue
+{
+private:
+  const char* name;
+  bool drain;
+  std::function<void(T&& item)> process;
+
+  // guarded by mutex
+  std::deque<T> pending;
+  bool running;
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::thread worker;
+
+  void Run();
+
+public:
+  BackgroundQueue(const char* name, bool drain, std::function<void(T&& item)> process);
+  ~BackgroundQueue();
+
+  BackgroundQueue(const BackgroundQueue& queue) = delete;
+  BackgroundQueue& operator=(const BackgroundQueue& queue) = delete;
+
+  void Push(T&& item);
+  // drops the item instead if maxPending are already waiting, false then
+  bool TryPush(T&& item, size_t maxPending);
+  void Clear();
+  size_t Pending();
+};
+
+template<typename T>
+BackgroundQueue<T>::BackgroundQueue(const char* name, bool drain, std::function<void(T&& item)> process)
+  : name(name), drain(drain), process(std::move(process)), running(true)
+{
+  worker = std::thread(&BackgroundQueue::Run, this);
+}
+
+template<typename T>
+BackgroundQueue<T>::~BackgroundQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+  }
+
+  condition.notify_one();
+  worker.join();
+}
+
+template<typename T>
+void BackgroundQueue<T>::Push(T&& item)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(std::move(item));
+  }
+
+  condition.notify_one();
+}
+
+template<typename T>
+bool BackgroundQueue<T>::TryPush(T&& item, size_t maxPending)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.size() >= maxPending)
+    {
+      return false;
+    }
+
+    pending.push_back(std::move(item));
+  }
+
+  condition.notify_one();
+  return true;
+}
+
+template<typename T>
+void BackgroundQueue<T>::Clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  pending.clear();
+}
+
+template<typename T>
+size_t BackgroundQueue<T>::Pending()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return pending.size();
+}
+
+template<typename T>
+void BackgroundQueue<T>::Run()
+{
+  PROFILE_THREAD(name);
+
+  while (true)
+  {
+    T item;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this]() { return !running || !pending.empty(); });
+
+      if (pending.empty() || (!running && !drain))
+      {
+        return;
+      }
+
+      item = std::move(pending.front());
+      pending.pop_front();
+    }
+
+    process(std::move(item));
+  }
+}
@@ -0,0 +1,283 @@
+#include "BatchEngine.h"
+#include "GameOfLifeVulkan.h"
+#include "Profile.h"
+
+#include <algorithm>
+#include <cstring>
+
+VkResult BatchEngine::Create(const ComputeContext& context, uint32_t width, uint32_t height, uint32_t count, Topology topology)
+{
+  this->context = &context;
+  this->width = width;
+  this->height = height;
+  this->count = count;
+  this->topology = topology;
+  wordsPerRow = 2 * ((width + 63) / 64);
+  parity = 0;
+
+  if (width == 0 || height == 0 || count == 0)
+  {
+    return VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  VkDevice device = context.device;
+
+  for (auto& buffer : boards)
+  {
+    auto bufferCreation = CreateBuffer(context.physicalDevice, device, BoardSize() * count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (std::holds_alternative<VkResult>(bufferCreation))
+    {
+      return std::get<VkResult>(bufferCreation);
+    }
+    buffer = std::get<Buffer>(bufferCreation);
+  }
+
+  // small enough to be read by the host directly
+  VkDeviceSize statsSize = VkDeviceSize(count) * sizeof(BatchStats);
+  auto bufferCreation = CreateBuffer(context.physicalDevice, device, statsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  if (std::holds_alternative<VkResult>(bufferCreation))
+  {
+    return std::get<VkResult>(bufferCreation);
+  }
+  stats = std::get<Buffer>(bufferCreation);
+
+  void* data;
+  auto result = vkMapMemory(device, stats.memory, 0, statsSize, 0, &data);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+  memset(data, 0, statsSize);
+  statsData = static_cast<const BatchStats*>(data);
+
+  VkDescriptorSetLayoutBinding inBinding = CreateDescriptorSetLayoutBinding(0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+  VkDescriptorSetLayoutBinding outBinding = CreateDescriptorSetLayoutBinding(1, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+  VkDescriptorSetLayoutBinding statsBinding = CreateDescriptorSetLayoutBinding(2, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+  auto descriptorSetLayoutCreation = CreateDescriptorSetLayout(device, { inBinding, outBinding, statsBinding });
+  if (std::holds_alternative<VkResult>(descriptorSetLayoutCreation))
+  {
+    return std::get<VkResult>(descriptorSetLayoutCreation);
+  }
+  descriptorSetLayout = std::get<VkDescriptorSetLayout>(descriptorSetLayoutCreation);
+
+  VkPushConstantRange pushConstant = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BatchPush) };
+  auto pipelineLayoutCreation = CreatePipelineLayout(device, { descriptorSetLayout }, { pushConstant });
+  if (std::holds_alternative<VkResult>(pipelineLayoutCreation))
+  {
+    return std::get<VkResult>(pipelineLayoutCreation);
+  }
+  pipelineLayout = std::get<VkPipelineLayout>(pipelineLayoutCreation);
+
+  auto pipelineCreation = CreateComputePipeline(device, pipelineLayout, "gol_batch.comp.spv");
+  if (std::holds_alternative<VkResult>(pipelineCreation))
+  {
+    return std::get<VkResult>(pipelineCreation);
+  }
+  pipeline = std::get<VkPipeline>(pipelineCreation);
+
+  result = AllocateCommandBuffer(device, context.commandPool, 1, &command);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  auto fenceCreation = CreateFence(device);
+  if (std::holds_alternative<VkResult>(fenceCreation))
+  {
+    return std::get<VkResult>(fenceCreation);
+  }
+  fence = std::get<VkFence>(fenceCreation);
+
+  return VK_SUCCESS;
+}
+
+void BatchEngine::Destroy()
+{
+  VkDevice device = context->device;
+  vkQueueWaitIdle(context->queue);
+
+  vkDestroyFence(device, fence, nullptr);
+  vkFreeCommandBuffers(device, context->commandPool, 1, &command);
+  vkDestroyPipeline(device, pipeline, nullptr);
+  vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+
+  vkUnmapMemory(device, stats.memory);
+  FreeBuffer(device, stats);
+
+  for (auto& buffer : boards)
+  {
+    FreeBuffer(device, buffer);
+  }
+}
+
+VkDeviceSize BatchEngine::BoardSize() const
+{
+  return VkDeviceSize(height) * wordsPerRow * sizeof(uint32_t);
+}
+
+VkResult BatchEngine::Submit(const std::function<void(VkCommandBuffer)>& record)
+{
+  auto result = BeginCommandBuffer(command, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  record(command);
+
+  result = vkEndCommandBuffer(command);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  result = QueueSubmit(context->queue, command, {}, {}, fence);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  result = vkWaitForFences(context->device, 1, &fence, VK_TRUE, UINT64_MAX);
+  vkResetFences(context->device, 1, &fence);
+  return result;
+}
+
+VkResult BatchEngine::SetBoards(const std::vector<PackedBoard>& boards)
+{
+  bool sized = std::all_of(boards.begin(), boards.end(), [this](const PackedBoard& board) { return board.width == width && board.height == height; });
+  if (boards.size() != count || !sized)
+  {
+    return VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  VkDevice device = context->device;
+  VkDeviceSize size = BoardSize() * count;
+
+  auto bufferCreation = CreateBuffer(context->physicalDevice, device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  if (std::holds_alternative<VkResult>(bufferCreation))
+  {
+    return std::get<VkResult>(bufferCreation);
+  }
+  Buffer staging = std::get<Buffer>(bufferCreation);
+
+  // a 64 bit word is two 32 bit words on a little endian host, padding bits included
+  void* data;
+  vkMapMemory(device, staging.memory, 0, size, 0, &data);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    memcpy(static_cast<uint8_t*>(data) + i * BoardSize(), boards[i].words.data(), size_t(BoardSize()));
+  }
+  vkUnmapMemory(device, staging.memory);
+
+  const Buffer& target = this->boards[parity];
+  auto result = Submit([&](VkCommandBuffer cmd)
+  {
+    GlobalBarrier(cmd, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkBufferCopy region = { 0, 0, size };
+    vkCmdCopyBuffer(cmd, staging.buffer, target.buffer, 1, &region);
+  });
+
+  FreeBuffer(device, staging);
+  return result;
+}
+
+VkResult BatchEngine::GetBoard(uint32_t index, PackedBoard* board)
+{
+  VkDevice device = context->device;
+  VkDeviceSize size = BoardSize();
+
+  auto bufferCreation = CreateBuffer(context->physicalDevice, device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  if (std::holds_alternative<VkResult>(bufferCreation))
+  {
+    return std::get<VkResult>(bufferCreation);
+  }
+  Buffer staging = std::get<Buffer>(bufferCreation);
+
+  const Buffer& source = boards[parity];
+  auto result = Submit([&](VkCommandBuffer cmd)
+  {
+    GlobalBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkBufferCopy region = { index * size, 0, size };
+    vkCmdCopyBuffer(cmd, source.buffer, staging.buffer, 1, &region);
+
+    GlobalBarrier(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+  });
+
+  if (result == VK_SUCCESS)
+  {
+    *board = CreatePackedBoard(width, height);
+
+    void* data;
+    vkMapMemory(device, staging.memory, 0, size, 0, &data);
+    memcpy(board->words.data(), data, size_t(size));
+    vkUnmapMemory(device, staging.memory);
+  }
+
+  FreeBuffer(device, staging);
+  return result;
+}
+
+VkResult BatchEngine::Step(uint32_t generations)
+{
+  // one invocation per 32 bit word of every board, spread over two dimensions past the dispatch limit
+  uint32_t groups = uint32_t((VkDeviceSize(count) * height * wordsPerRow + 255) / 256);
+  uint32_t groupsX = std::min(groups, 65535u);
+  uint32_t groupsY = (groups + groupsX - 1) / groupsX;
+
+  BatchPush push = { width, height, wordsPerRow, count, topology == Topology::Torus ? 1u : 0u, 0 };
+  // the write descriptor sets only point at the infos, they have to live until pushed
+  std::vector<VkDescriptorBufferInfo> statsInfos = { CreateDescriptorBufferInfo(stats.buffer, 0, VK_WHOLE_SIZE) };
+
+  for (uint32_t done = 0; done < generations; )
+  {
+    PROFILE_SCOPE("batch submit");
+
+    uint32_t batch = std::min(MAX_GENERATIONS_PER_SUBMIT, generations - done);
+    bool last = done + batch == generations;
+
+    auto result = Submit([&](VkCommandBuffer cmd)
+    {
+      if (last)
+      {
+        vkCmdFillBuffer(cmd, stats.buffer, 0, VK_WHOLE_SIZE, 0);
+      }
+
+      GlobalBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+      vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+      for (uint32_t g = 0; g < batch; g++)
+      {
+        std::vector<VkDescriptorBufferInfo> inInfos = { CreateDescriptorBufferInfo(boards[parity].buffer, 0, VK_WHOLE_SIZE) };
+        std::vector<VkDescriptorBufferInfo> outInfos = { CreateDescriptorBufferInfo(boards[1 - parity].buffer, 0, VK_WHOLE_SIZE) };
+
+        std::array<VkWriteDescriptorSet, 3> writeDescriptorSets = {};
+        writeDescriptorSets[0] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, inInfos, {});
+        writeDescriptorSets[1] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, outInfos, {});
+        writeDescriptorSets[2] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 2, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, statsInfos, {});
+
+        push.gather = last && g + 1 == batch ? 1 : 0;
+
+        context->vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, uint32_t(writeDescriptorSets.size()), writeDescriptorSets.data());
+        vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BatchPush), &push);
+        vkCmdDispatch(cmd, groupsX, groupsY, 1);
+
+        GlobalBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        parity = 1 - parity;
+      }
+
+      GlobalBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+    });
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    done += batch;
+  }
+
+  return VK_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Structs.h"
+#include "Board.h"
+
+// Many small independent boards of the same size, e.g. soups searched for interesting patterns,
+// stepped together by one dispatch per generation. The boards lie one after the other in a single
+// storage buffer, packed like PackedBoard, so thousands of them fit on a device and keep it busy
+// where a single small board would leave most of it idle.
+class BatchEngine
+{
+private:
+  // generations recorded into one submit, a long run gets split so a single submit never takes too long
+  static constexpr uint32_t MAX_GENERATIONS_PER_SUBMIT = 256;
+
+  // layout matches the push constants of gol_batch.comp
+  struct BatchPush
+  {
+    uint32_t width;
+    uint32_t height;
+    uint32_t wordsPerRow;
+    uint32_t count;
+    uint32_t wrap;
+    uint32_t gather;
+  };
+
+  const ComputeContext* context;
+  uint32_t width;
+  uint32_t height;
+  uint32_t count;
+  // 32 bit words, twice the words of a PackedBoard row
+  uint32_t wordsPerRow;
+  Topology topology;
+  uint32_t parity;
+
+  std::array<Buffer, 2> boards;
+  Buffer stats;
+  const BatchStats* statsData;
+
+  VkDescriptorSetLayout descriptorSetLayout;
+  VkPipelineLayout pipelineLayout;
+  VkPipeline pipeline;
+
+  VkCommandBuffer command;
+  VkFence fence;
+
+  VkDeviceSize BoardSize() const;
+  VkResult Submit(const std::function<void(VkCommandBuffer)>& record);
+
+public:
+  BatchEngine() = default;
+  ~BatchEngine() = default;
+
+  // the context has to outlive the engine
+  VkResult Create(const ComputeContext& context, uint32_t width, uint32_t height, uint32_t count, Topology topology);
+  void Destroy();
+
+  uint32_t Count() const { return count; }
+
+  // one board per slot of the batch, all of the engine's size
+  VkResult SetBoards(const std::vector<PackedBoard>& boards);
+  VkResult GetBoard(uint32_t index, PackedBoard* board);
+
+  // steps every board, the stats are gathered on the last of the generations
+  VkResult Step(uint32_t generations);
+  const BatchStats& Stats(uint32_t index) const { return statsData[index]; }
+};
@@ -0,0 +1,184 @@
+#include "Board.h"
+#include "Threads.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <vector>
+
+// the density is resolved to 1 / 2^DENSITY_BITS
+constexpr uint32_t DENSITY_BITS = 16;
+
+// splitmix64 finalizer, a full avalanche of the counter
+static uint64_t Mix(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBull;
+  x ^= x >> 31;
+  return x;
+}
+
+PackedBoard CreatePackedBoard(uint32_t width, uint32_t height)
+{
+  PackedBoard board = {};
+  board.width = width;
+  board.height = height;
+  board.wordsPerRow = (width + 63) / 64;
+  board.words.resize(size_t(board.wordsPerRow) * height);
+
+  return board;
+}
+
+bool GetCell(const PackedBoard& board, uint32_t x, uint32_t y)
+{
+  return (board.words[size_t(y) * board.wordsPerRow + x / 64] >> (x % 64)) & 1;
+}
+
+void SetCell(PackedBoard* board, uint32_t x, uint32_t y, bool alive)
+{
+  uint64_t& word = board->words[size_t(y) * board->wordsPerRow + x / 64];
+  uint64_t bit = uint64_t(1) << (x % 64);
+
+  word = alive ? word | bit : word & ~bit;
+}
+
+PackedBoard PackPositions(const std::vector<Position>& positions, uint32_t width, uint32_t height)
+{
+  PackedBoard board = CreatePackedBoard(width, height);
+
+  for (auto& pos : positions)
+  {
+    if (pos.x < width && pos.y < height)
+    {
+      SetCell(&board, pos.x, pos.y, true);
+    }
+  }
+
+  return board;
+}
+
+std::vector<Position> UnpackPositions(const PackedBoard& board)
+{
+  std::vector<Position> positions;
+
+  for (uint32_t y = 0; y < board.height; y++)
+  {
+    for (uint32_t w = 0; w < board.wordsPerRow; w++)
+    {
+      uint64_t word = board.words[size_t(y) * board.wordsPerRow + w];
+
+      // only visit the set bits, boards are mostly empty
+      while (word != 0)
+      {
+        positions.push_back({ w * 64 + LowestSetBit(word), y });
+        word &= word - 1;
+      }
+    }
+  }
+
+  return positions;
+}
+
+std::vector<uint32_t> UnpackTexels(const PackedBoard& board)
+{
+  std::vector<uint32_t> texels(size_t(board.width) * board.height);
+  UnpackTexelRows(board, 0, board.height, texels.data());
+
+  return texels;
+}
+
+void UnpackTexelRows(const PackedBoard& board, uint32_t firstRow, uint32_t rows, uint32_t* texels)
+{
+  for (uint32_t y = 0; y < rows; y++)
+  {
+    for (uint32_t x = 0; x < board.width; x++)
+    {
+      texels[size_t(y) * board.width + x] = GetCell(board, x, firstRow + y) ? 0xFFFFFFFF : 0;
+    }
+  }
+}
+
+PackedBoard PackTexels(const uint32_t* texels, uint32_t width, uint32_t height)
+{
+  PackedBoard board = CreatePackedBoard(width, height);
+
+  for (uint32_t y = 0; y < height; y++)
+  {
+    for (uint32_t x = 0; x < width; x++)
+    {
+      // alpha lives in the highest byte of a R8G8B8A8 texel
+      if ((texels[size_t(y) * width + x] >> 24) > 0x40)
+      {
+        SetCell(&board, x, y, true);
+      }
+    }
+  }
+
+  return board;
+}
+
+uint64_t CountCells(const PackedBoard& board)
+{
+  uint64_t count = 0;
+  for (auto word : board.words)
+  {
+    count += std::bitset<64>(word).count();
+  }
+
+  return count;
+}
+
+PackedBoard RandomBoard(uint32_t width, uint32_t height, double density, uint64_t seed, uint32_t firstRow)
+{
+  PackedBoard board = CreatePackedBoard(width, height);
+
+  uint32_t threshold = uint32_t(std::lround(std::min(std::max(density, 0.0), 1.0) * (1 << DENSITY_BITS)));
+  if (threshold == 0)
+  {
+    return board;
+  }
+
+  uint64_t key = Mix(seed + 0x9E3779B97F4A7C15ull);
+  uint64_t lastWordMask = width % 64 ? (uint64_t(1) << (width % 64)) - 1 : ~uint64_t(0);
+
+  // bit sliced compare of 64 uniform DENSITY_BITS numbers against the threshold, from its lowest set bit up:
+  // a 1 bit ORs in the next random word, a 0 bit ANDs it, which leaves every bit set with probability threshold / 2^DENSITY_BITS
+  // (the bits below the lowest set one would only AND into zero, so they cost no draws)
+  uint32_t lowest = LowestSetBit(threshold);
+
+  auto fillRows = [&](uint32_t begin, uint32_t end)
+  {
+    for (uint32_t y = begin; y < end; y++)
+    {
+      for (uint32_t w = 0; w < board.wordsPerRow; w++)
+      {
+        // DENSITY_BITS draws per word at most
+        uint64_t counter = (uint64_t(firstRow + y) * board.wordsPerRow + w) * DENSITY_BITS;
+
+        uint64_t word = ~uint64_t(0);
+        if (threshold < (1u << DENSITY_BITS))
+        {
+          word = 0;
+          for (uint32_t bit = lowest; bit < DENSITY_BITS; bit++)
+          {
+            uint64_t random = Mix(key ^ (counter + bit));
+            word = (threshold >> bit) & 1 ? word | random : word & random;
+          }
+        }
+
+        board.words[size_t(y) * board.wordsPerRow + w] = w + 1 == board.wordsPerRow ? word & lastWordMask : word;
+      }
+    }
+  };
+
+  // rows are independent, so they are simply split over the cores
+  uint32_t threadCount = ThreadCount(height / 64);
+  ForEachThread(threadCount, [&](uint32_t t)
+  {
+    fillRows(uint32_t(uint64_t(height) * t / threadCount), uint32_t(uint64_t(height) * (t + 1) / threadCount));
+  });
+
+  return board;
+}
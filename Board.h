@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#if _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "Structs.h"
+
+// one bit per cell, bit i of word w in row y is the cell (w * 64 + i, y)
+// rows are padded to whole words, the padding bits are always 0
+struct PackedBoard
+{
+  uint32_t width;
+  uint32_t height;
+  uint32_t wordsPerRow;
+  std::vector<uint64_t> words;
+};
+
+// index of the lowest set bit, word must not be 0
+inline uint32_t LowestSetBit(uint64_t word)
+{
+#if _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, word);
+  return uint32_t(index);
+#else
+  return uint32_t(__builtin_ctzll(word));
+#endif
+}
+
+PackedBoard CreatePackedBoard(uint32_t width, uint32_t height);
+
+bool GetCell(const PackedBoard& board, uint32_t x, uint32_t y);
+void SetCell(PackedBoard* board, uint32_t x, uint32_t y, bool alive);
+
+PackedBoard PackPositions(const std::vector<Position>& positions, uint32_t width, uint32_t height);
+std::vector<Position> UnpackPositions(const PackedBoard& board);
+std::vector<uint32_t> UnpackTexels(const PackedBoard& board);
+
+// rows firstRow .. firstRow + rows - 1 as texels into width * rows texels, for a part of a board that is never unpacked as a whole
+void UnpackTexelRows(const PackedBoard& board, uint32_t firstRow, uint32_t rows, uint32_t* texels);
+PackedBoard PackTexels(const uint32_t* texels, uint32_t width, uint32_t height);
+
+uint64_t CountCells(const PackedBoard& board);
+
+// every cell is alive with the given density, drawn from a counter based generator keyed by the seed and the cell's position,
+// so the same seed always gives the same soup and a strip starting at firstRow equals those rows of the whole board
+PackedBoard RandomBoard(uint32_t width, uint32_t height, double density, uint64_t seed, uint32_t firstRow = 0);
@@ -39,6 +39,12 @@ Camera & Camera::operator=(const Camera & camera)
   return *this;
 }
 
+void Camera::Resize(VkExtent2D extent)
+{
+  this->extent = extent;
+  dirty = true;
+}
+
 void Camera::Move(const glm::vec3 & delta)
 {
   position += delta;
@@ -64,7 +70,10 @@ glm::vec4 Camera::ScreenToWorld(uint32_t screenX, uint32_t screenY, float z)
   in.z = 0;
   in.w = 1.0f;
 
-  glm::vec4 out = in * inverse;
+  // the inverse has to match the current position, not the one of the last frame
+  WorldToScreenMatrix();
+
+  glm::vec4 out = inverse * in;
   // out.w = 1.0f / out.w;
   // out.x *= out.w;
   // out.y *= out.w;
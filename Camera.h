@@ -52,6 +52,7 @@ public:
   Camera& operator=(const Camera& camera);
   Camera& operator=(Camera&& camera) = delete;
 
+  void Resize(VkExtent2D extent);
   void Move(const glm::vec3& delta);
   void Rotate(float theta, const glm::vec3& axis);
 
@@ -0,0 +1,459 @@
+#include "Census.h"
+#include "CpuEngine.h"
+#include "Profile.h"
+#include "Threads.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+// the objects a census knows, rows separated by '/', 'o' for a live cell
+static const std::vector<std::pair<const char*, const char*>> KNOWN_OBJECTS =
+{
+  { "block", "oo/oo" },
+  { "beehive", ".oo./o..o/.oo." },
+  { "loaf", ".oo./o..o/.o.o/..o." },
+  { "boat", "oo./o.o/.o." },
+  { "ship", "oo./o.o/.oo" },
+  { "tub", ".o./o.o/.o." },
+  { "pond", ".oo./o..o/o..o/.oo." },
+  { "barge", ".o../o.o./.o.o/..o." },
+  { "long boat", ".o../o.o./.o.o/..oo" },
+  { "mango", ".oo../o..o./.o..o/..oo." },
+  { "eater", "oo../o.o./..o./..oo" },
+  { "blinker", "ooo" },
+  { "toad", ".ooo/ooo." },
+  { "beacon", "oo../oo../..oo/..oo" },
+  { "pulsar", "..ooo...ooo../............./o....o.o....o/o....o.o....o/o....o.o....o/..ooo...ooo../............./..ooo...ooo../o....o.o....o/o....o.o....o/o....o.o....o/............./..ooo...ooo.." },
+  { "traffic light", "..ooo../......./o.....o/o.....o/o.....o/......./..ooo.." },
+  { "pentadecathlon", "..o....o../oo.oooo.oo/..o....o.." },
+  { "glider", ".o./..o/ooo" },
+  { "lwss", ".o..o/o..../o...o/oooo." },
+  { "mwss", "..o.../o...o./.....o/o....o/.ooooo" },
+  { "hwss", "..oo.../o....o./......o/o.....o/.oooooo" }
+};
+
+// long enough for every phase of the known objects, pentadecathlon has the longest period with 15
+static constexpr uint32_t KNOWN_GENERATIONS = 30;
+
+// the period of every known spaceship
+static constexpr uint32_t SPACESHIP_PERIOD = 4;
+
+// how far a spaceship has to be beyond everything else before it counts as escaped; the rest can still
+// throw out sparks for a few cells, but no spaceship is faster than half the speed of light
+static constexpr int64_t ESCAPE_MARGIN = 8;
+
+struct KnownObject
+{
+  CensusEntry entry;
+  bool moves;
+};
+
+struct Box
+{
+  int64_t minX = INT64_MAX;
+  int64_t minY = INT64_MAX;
+  int64_t maxX = INT64_MIN;
+  int64_t maxY = INT64_MIN;
+
+  bool Empty() const { return minX > maxX; }
+
+  void Add(int64_t x, int64_t y)
+  {
+    minX = std::min(minX, x);
+    minY = std::min(minY, y);
+    maxX = std::max(maxX, x);
+    maxY = std::max(maxY, y);
+  }
+
+  void Add(const Box& box)
+  {
+    if (!box.Empty())
+    {
+      Add(box.minX, box.minY);
+      Add(box.maxX, box.maxY);
+    }
+  }
+};
+
+// with path halving, every find flattens the tree a little
+static uint32_t Find(std::vector<uint32_t>& parent, uint32_t i)
+{
+  while (parent[i] != i)
+  {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+
+  return i;
+}
+
+// the lower root wins, so the labels don't depend on the order of the unions
+static void Union(std::vector<uint32_t>& parent, uint32_t a, uint32_t b)
+{
+  a = Find(parent, a);
+  b = Find(parent, b);
+  if (a < b)
+  {
+    parent[b] = a;
+  }
+  else if (b < a)
+  {
+    parent[a] = b;
+  }
+}
+
+// the smallest of the eight rotations and reflections of the cells, moved to the origin and sorted, as FNV-1a
+static uint64_t CanonicalHash(const std::vector<Position>& cells)
+{
+  std::vector<std::pair<int64_t, int64_t>> best;
+  std::vector<std::pair<int64_t, int64_t>> transformed(cells.size());
+
+  for (uint32_t t = 0; t < 8; t++)
+  {
+    int64_t minX = INT64_MAX;
+    int64_t minY = INT64_MAX;
+    for (size_t i = 0; i < cells.size(); i++)
+    {
+      int64_t x = t & 1 ? -int64_t(cells[i].x) : int64_t(cells[i].x);
+      int64_t y = t & 2 ? -int64_t(cells[i].y) : int64_t(cells[i].y);
+      transformed[i] = t & 4 ? std::make_pair(x, y) : std::make_pair(y, x);
+      minX = std::min(minX, transformed[i].second);
+      minY = std::min(minY, transformed[i].first);
+    }
+
+    for (auto& cell : transformed)
+    {
+      cell.first -= minY;
+      cell.second -= minX;
+    }
+
+    std::sort(transformed.begin(), transformed.end());
+    if (best.empty() || transformed < best)
+    {
+      best = transformed;
+    }
+  }
+
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (const auto& cell : best)
+  {
+    for (uint64_t value : { uint64_t(cell.first), uint64_t(cell.second) })
+    {
+      for (uint32_t i = 0; i < 8; i++)
+      {
+        hash ^= (value >> (8 * i)) & 0xFF;
+        hash *= 0x100000001B3ull;
+      }
+    }
+  }
+
+  return hash;
+}
+
+// every phase of every known object to the object in the phase it is written in, stepped alone on a board
+// large enough that the spaceships stay on it
+static const std::unordered_map<uint64_t, KnownObject>& KnownObjects()
+{
+  static const std::unordered_map<uint64_t, KnownObject> known = []()
+  {
+    std::unordered_map<uint64_t, KnownObject> objects;
+    const uint32_t size = 64;
+
+    for (const auto& object : KNOWN_OBJECTS)
+    {
+      CpuEngine engine(size, size, Topology::Plane);
+
+      std::istringstream rows(object.second);
+      std::string row;
+      for (uint32_t y = size / 3; std::getline(rows, row, '/'); y++)
+      {
+        for (uint32_t x = 0; x < row.size(); x++)
+        {
+          engine.SetCell(size / 3 + x, y, row[x] == 'o');
+        }
+      }
+
+      std::vector<Position> cells = UnpackPositions(engine.GetBoard());
+      KnownObject known = { { object.first, uint32_t(cells.size()), CanonicalHash(cells), 0 }, false };
+
+      std::vector<uint64_t> hashes;
+      for (uint32_t generation = 0; generation < KNOWN_GENERATIONS; generation++)
+      {
+        std::vector<Position> phase = UnpackPositions(engine.GetBoard());
+        hashes.push_back(CanonicalHash(phase));
+
+        // a spaceship is back in its shape after a period, but somewhere else
+        if (generation == SPACESHIP_PERIOD)
+        {
+          known.moves = hashes.back() == hashes.front() && (phase[0].x != cells[0].x || phase[0].y != cells[0].y);
+        }
+
+        engine.Step();
+      }
+
+      for (uint64_t hash : hashes)
+      {
+        objects.emplace(hash, known);
+      }
+    }
+
+    return objects;
+  }();
+
+  return known;
+}
+
+// the cells of every object, cells sorted by row, then by column
+static std::vector<std::vector<Position>> LabelObjects(const std::vector<Position>& cells)
+{
+  uint32_t count = uint32_t(cells.size());
+
+  // the first cell of every row with live cells, and the end of the last one
+  std::vector<uint32_t> rowBegins;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (i == 0 || cells[i].y != cells[i - 1].y)
+    {
+      rowBegins.push_back(i);
+    }
+  }
+  uint32_t rows = uint32_t(rowBegins.size());
+  rowBegins.push_back(count);
+
+  std::vector<uint32_t> parent(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    parent[i] = i;
+  }
+
+  // joins cell i with the cells up to two columns away in the rows from firstRow up to its own, left of it in its own
+  auto joinRow = [&](uint32_t row, uint32_t firstRow)
+  {
+    for (uint32_t i = rowBegins[row]; i < rowBegins[row + 1]; i++)
+    {
+      const Position& cell = cells[i];
+      if (i > rowBegins[row] && cells[i - 1].x + 2 >= cell.x)
+      {
+        Union(parent, i - 1, i);
+      }
+
+      for (uint32_t above = row > firstRow + 2 ? row - 2 : firstRow; above < row; above++)
+      {
+        if (cells[rowBegins[above]].y + 2 < cell.y)
+        {
+          continue;
+        }
+
+        auto begin = cells.begin() + rowBegins[above];
+        auto end = cells.begin() + rowBegins[above + 1];
+        auto first = std::lower_bound(begin, end, cell.x < 2 ? 0 : cell.x - 2, [](const Position& p, uint32_t x) { return p.x < x; });
+        for (auto it = first; it != end && it->x <= cell.x + 2; ++it)
+        {
+          Union(parent, uint32_t(it - cells.begin()), i);
+        }
+      }
+    }
+  };
+
+  // every chunk of rows only touches the cells inside it, the first two rows of a chunk are joined with the one before later
+  uint32_t chunks = ThreadCount(rows / 64);
+  auto chunkBegin = [&](uint32_t chunk) { return uint32_t(uint64_t(rows) * chunk / chunks); };
+
+  ForEachThread(chunks, [&](uint32_t chunk)
+  {
+    for (uint32_t row = chunkBegin(chunk); row < chunkBegin(chunk + 1); row++)
+    {
+      joinRow(row, chunkBegin(chunk));
+    }
+  });
+
+  for (uint32_t chunk = 1; chunk < chunks; chunk++)
+  {
+    uint32_t begin = chunkBegin(chunk);
+    for (uint32_t row = begin; row < std::min(begin + 2, chunkBegin(chunk + 1)); row++)
+    {
+      joinRow(row, begin >= 2 ? begin - 2 : 0);
+    }
+  }
+
+  // the cells of every object, in the order their roots come up
+  std::vector<uint32_t> objectOf(count, UINT32_MAX);
+  std::vector<std::vector<Position>> objects;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t root = Find(parent, i);
+    if (objectOf[root] == UINT32_MAX)
+    {
+      objectOf[root] = uint32_t(objects.size());
+      objects.emplace_back();
+    }
+    objects[objectOf[root]].push_back(cells[i]);
+  }
+
+  return objects;
+}
+
+// how far a spaceship moves in a period, stepped alone on a board just large enough
+static void Velocity(const std::vector<Position>& cells, int64_t* dx, int64_t* dy)
+{
+  Box box;
+  for (const auto& cell : cells)
+  {
+    box.Add(cell.x, cell.y);
+  }
+
+  uint32_t border = SPACESHIP_PERIOD + 2;
+  CpuEngine engine(uint32_t(box.maxX - box.minX) + 1 + 2 * border, uint32_t(box.maxY - box.minY) + 1 + 2 * border, Topology::Plane);
+  for (const auto& cell : cells)
+  {
+    engine.SetCell(uint32_t(cell.x - box.minX) + border, uint32_t(cell.y - box.minY) + border, true);
+  }
+
+  for (uint32_t generation = 0; generation < SPACESHIP_PERIOD; generation++)
+  {
+    engine.Step();
+  }
+
+  Box later;
+  for (const auto& cell : UnpackPositions(engine.GetBoard()))
+  {
+    later.Add(cell.x, cell.y);
+  }
+
+  *dx = later.minX - border;
+  *dy = later.minY - border;
+}
+
+std::vector<CensusEntry> TakeCensus(const PackedBoard& board)
+{
+  return TakeCensus(UnpackPositions(board));
+}
+
+std::vector<CensusEntry> TakeCensus(const std::vector<Position>& cells)
+{
+  PROFILE_SCOPE("census");
+
+  const auto& known = KnownObjects();
+  std::vector<std::vector<Position>> objects = LabelObjects(cells);
+
+  // hashed on every core, each into its own tally, all phases of a known object under the hash of its first one
+  uint32_t threadCount = ThreadCount(uint32_t(objects.size() / 256));
+  std::vector<std::unordered_map<uint64_t, CensusEntry>> tallies(threadCount);
+
+  ForEachThread(threadCount, [&](uint32_t t)
+  {
+    for (size_t o = t; o < objects.size(); o += threadCount)
+    {
+      uint64_t hash = CanonicalHash(objects[o]);
+      auto object = known.find(hash);
+      CensusEntry entry = object != known.end() ? object->second.entry : CensusEntry{ "unknown", uint32_t(objects[o].size()), hash, 0 };
+      tallies[t].emplace(entry.hash, entry).first->second.count++;
+    }
+  });
+
+  std::unordered_map<uint64_t, CensusEntry> tally;
+  for (const auto& local : tallies)
+  {
+    for (const auto& entry : local)
+    {
+      auto it = tally.emplace(entry.first, entry.second);
+      if (!it.second)
+      {
+        it.first->second.count += entry.second.count;
+      }
+    }
+  }
+
+  std::vector<CensusEntry> census;
+  for (const auto& entry : tally)
+  {
+    census.push_back(entry.second);
+  }
+
+  std::sort(census.begin(), census.end(), [](const CensusEntry& a, const CensusEntry& b) { return a.count != b.count ? a.count > b.count : a.hash < b.hash; });
+  return census;
+}
+
+std::vector<Escapee> FindEscapees(const std::vector<Position>& cells)
+{
+  PROFILE_SCOPE("find escapees");
+
+  const auto& known = KnownObjects();
+  std::vector<std::vector<Position>> objects = LabelObjects(cells);
+
+  // everything that isn't a spaceship stays
+  Box rest;
+  std::vector<Escapee> candidates;
+  std::vector<Box> boxes;
+  for (auto& members : objects)
+  {
+    Box box;
+    for (const auto& cell : members)
+    {
+      box.Add(cell.x, cell.y);
+    }
+
+    auto object = known.find(CanonicalHash(members));
+    if (object == known.end() || !object->second.moves)
+    {
+      rest.Add(box);
+      continue;
+    }
+
+    Escapee escapee = { object->second.entry.name, std::move(members), 0, 0 };
+    Velocity(escapee.cells, &escapee.dx, &escapee.dy);
+    candidates.push_back(std::move(escapee));
+    boxes.push_back(box);
+  }
+
+  // until no spaceship that stays is in the way of another one any more; spaceships moving the same way never meet,
+  // so the ones that stay are kept apart by their velocity, and a stream of gliders leaves one after another
+  std::map<std::pair<int64_t, int64_t>, Box> staying;
+  std::vector<bool> escapes(candidates.size(), true);
+  for (bool changed = true; changed;)
+  {
+    changed = false;
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+      if (!escapes[i])
+      {
+        continue;
+      }
+
+      auto velocity = std::make_pair(candidates[i].dx, candidates[i].dy);
+      Box others = rest;
+      for (const auto& group : staying)
+      {
+        if (group.first != velocity)
+        {
+          others.Add(group.second);
+        }
+      }
+
+      const Box& box = boxes[i];
+      bool away = others.Empty() ||
+        (velocity.first > 0 && box.minX > others.maxX + ESCAPE_MARGIN) || (velocity.first < 0 && box.maxX + ESCAPE_MARGIN < others.minX) ||
+        (velocity.second > 0 && box.minY > others.maxY + ESCAPE_MARGIN) || (velocity.second < 0 && box.maxY + ESCAPE_MARGIN < others.minY);
+
+      if (!away)
+      {
+        escapes[i] = false;
+        staying[velocity].Add(box);
+        changed = true;
+      }
+    }
+  }
+
+  std::vector<Escapee> escapees;
+  for (size_t i = 0; i < candidates.size(); i++)
+  {
+    if (escapes[i])
+    {
+      escapees.push_back(std::move(candidates[i]));
+    }
+  }
+
+  return escapees;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Structs.h"
+#include "Board.h"
+
+// one kind of object on a board, a known one by name with all its phases together and any other as "unknown"
+// with the hash of its canonical form, so unknown objects can still be told apart and compared between runs.
+// cells is the size of a known object in the phase it is usually drawn in
+struct CensusEntry
+{
+  std::string name;
+  uint32_t cells;
+  uint64_t hash;
+  uint64_t count;
+};
+
+// Splits the live cells into objects and counts every kind of them, most common first.
+// Cells less than three apart in both directions belong to the same object, so every phase of a beacon
+// or a pulsar stays in one piece. The labeling is a union find over bands of rows spread over the cores,
+// joined at the seams of the bands afterwards. Every object is then hashed in its canonical form, the
+// smallest of its eight rotations and reflections moved to the origin, and looked up among every phase
+// of the common still lifes, oscillators and spaceships.
+// Objects across the edges of a torus are counted as their pieces.
+std::vector<CensusEntry> TakeCensus(const PackedBoard& board);
+
+// positions sorted by row, then by column
+std::vector<CensusEntry> TakeCensus(const std::vector<Position>& cells);
+
+// a known spaceship on its way out of the pattern, with how far it moves per period of four generations
+struct Escapee
+{
+  std::string name;
+  std::vector<Position> cells;
+  int64_t dx;
+  int64_t dy;
+};
+
+// The known spaceships that have left everything else behind: beyond the bounding box of the rest of the cells by
+// a margin, on a side they move away from. The rest includes every spaceship that doesn't escape itself and moves
+// differently, so one flying into another one stays. Meant for the plane, where they would otherwise fly on forever
+// or crash into the edge; two escaping spaceships are never checked against each other.
+// positions sorted by row, then by column
+std::vector<Escapee> FindEscapees(const std::vector<Position>& cells);
@@ -0,0 +1,371 @@
+#include "CpuEngine.h"
+#include "Profile.h"
+#include "Threads.h"
+
+#include <algorithm>
+#include <bitset>
+
+// words [begin, end) of a row, the words around them are read as neighbours
+static inline void StepRow(const uint64_t* up, const uint64_t* row, const uint64_t* down, uint64_t* out, uint32_t begin, uint32_t end)
+{
+  for (uint32_t x = begin; x < end; x++)
+  {
+    // bit i of west holds cell i - 1, bit i of east holds cell i + 1
+    uint64_t neighbours[8] =
+    {
+      (up[x] << 1) | (up[x - 1] >> 63), up[x], (up[x] >> 1) | (up[x + 1] << 63),
+      (row[x] << 1) | (row[x - 1] >> 63), (row[x] >> 1) | (row[x + 1] << 63),
+      (down[x] << 1) | (down[x - 1] >> 63), down[x], (down[x] >> 1) | (down[x + 1] << 63)
+    };
+
+    // count the neighbours of all 64 cells at once, s2 saturates at 4 or more
+    uint64_t s0 = 0, s1 = 0, s2 = 0;
+    for (uint64_t n : neighbours)
+    {
+      uint64_t c0 = s0 & n;
+      s0 ^= n;
+      uint64_t c1 = s1 & c0;
+      s1 ^= c0;
+      s2 |= c1;
+    }
+
+    // alive with 3, or with 2 if alive before
+    out[x] = ~s2 & s1 & (s0 | row[x]);
+  }
+}
+
+CpuEngine::CpuEngine(uint32_t width, uint32_t height, Topology topology) : width(width), height(height), topology(topology)
+{
+  wordsPerRow = (width + 63) / 64;
+  stride = wordsPerRow + 2;
+  lastWordMask = width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (width % 64)) - 1;
+
+  cells.resize(size_t(stride) * (height + 2));
+  next.resize(cells.size());
+}
+
+void CpuEngine::SetBoard(const PackedBoard& board)
+{
+  std::fill(cells.begin(), cells.end(), 0);
+
+  for (uint32_t y = 0; y < height && y < board.height; y++)
+  {
+    const uint64_t* src = &board.words[size_t(y) * board.wordsPerRow];
+    uint64_t* dst = &cells[size_t(y + 1) * stride + 1];
+
+    std::copy(src, src + std::min(wordsPerRow, board.wordsPerRow), dst);
+    dst[wordsPerRow - 1] &= lastWordMask;
+  }
+}
+
+void CpuEngine::SetRow(uint32_t y, const uint64_t* words)
+{
+  uint64_t* dst = &cells[size_t(y + 1) * stride + 1];
+
+  std::copy(words, words + wordsPerRow, dst);
+  dst[wordsPerRow - 1] &= lastWordMask;
+}
+
+PackedBoard CpuEngine::GetBoard() const
+{
+  PackedBoard board = CreatePackedBoard(width, height);
+
+  for (uint32_t y = 0; y < height; y++)
+  {
+    const uint64_t* src = &cells[size_t(y + 1) * stride + 1];
+    uint64_t* dst = &board.words[size_t(y) * wordsPerRow];
+
+    std::copy(src, src + wordsPerRow, dst);
+    dst[wordsPerRow - 1] &= lastWordMask;
+  }
+
+  return board;
+}
+
+void CpuEngine::SetCell(uint32_t x, uint32_t y, bool alive)
+{
+  if (x >= width || y >= height)
+  {
+    return;
+  }
+
+  uint64_t& word = cells[size_t(y + 1) * stride + 1 + x / 64];
+  uint64_t bit = uint64_t(1) << (x % 64);
+  word = alive ? word | bit : word & ~bit;
+}
+
+void CpuEngine::CopyHalo(const uint64_t* above, const uint64_t* below)
+{
+  uint32_t tail = width % 64;
+
+  // rows first, the column halo of the halo rows then takes care of the corners
+  uint64_t* top = &cells[1];
+  uint64_t* bottom = &cells[size_t(height + 1) * stride + 1];
+
+  if (above)
+  {
+    std::copy(above, above + wordsPerRow, top);
+    top[wordsPerRow - 1] &= lastWordMask;
+  }
+  else
+  {
+    std::fill(top, top + wordsPerRow, 0);
+  }
+
+  if (below)
+  {
+    std::copy(below, below + wordsPerRow, bottom);
+    bottom[wordsPerRow - 1] &= lastWordMask;
+  }
+  else
+  {
+    std::fill(bottom, bottom + wordsPerRow, 0);
+  }
+
+  for (uint32_t y = 0; y <= height + 1; y++)
+  {
+    uint64_t* row = &cells[size_t(y) * stride];
+
+    if (topology == Topology::Torus)
+    {
+      uint64_t first = row[1] & 1;
+      uint64_t last = (row[wordsPerRow] >> ((width - 1) % 64)) & 1;
+
+      // only the neighbour bits next to the edge cells matter, the west one is bit 63 of the
+      // left halo, the east one the first padding bit or bit 0 of the right halo
+      row[0] = last << 63;
+      if (tail != 0)
+      {
+        row[wordsPerRow] |= first << tail;
+        row[wordsPerRow + 1] = 0;
+      }
+      else
+      {
+        row[wordsPerRow + 1] = first;
+      }
+    }
+    else
+    {
+      row[0] = 0;
+      row[wordsPerRow + 1] = 0;
+    }
+  }
+}
+
+uint64_t CpuEngine::CountCells() const
+{
+  uint64_t count = 0;
+
+  for (uint32_t y = 1; y <= height; y++)
+  {
+    const uint64_t* row = &cells[size_t(y) * stride + 1];
+    for (uint32_t x = 0; x < wordsPerRow; x++)
+    {
+      count += std::bitset<64>(x + 1 == wordsPerRow ? row[x] & lastWordMask : row[x]).count();
+    }
+  }
+
+  return count;
+}
+
+void CpuEngine::Step()
+{
+  if (topology == Topology::Torus)
+  {
+    Step(Row(height - 1), Row(0));
+  }
+  else
+  {
+    Step(nullptr, nullptr);
+  }
+}
+
+void CpuEngine::Step(const uint64_t* above, const uint64_t* below)
+{
+  PROFILE_SCOPE("cpu step");
+
+  CopyHalo(above, below);
+
+  for (uint32_t y = 1; y <= height; y++)
+  {
+    const uint64_t* up = &cells[size_t(y - 1) * stride];
+    const uint64_t* row = &cells[size_t(y) * stride];
+    const uint64_t* down = &cells[size_t(y + 1) * stride];
+    uint64_t* out = &next[size_t(y) * stride];
+
+    StepRow(up, row, down, out, 1, wordsPerRow + 1);
+
+    out[wordsPerRow] &= lastWordMask;
+  }
+
+  cells.swap(next);
+}
+
+uint64_t CpuEngine::CellsAt(const uint64_t* row, int64_t firstCell) const
+{
+  uint64_t word = 0;
+
+  for (uint32_t bit = 0; bit < 64; )
+  {
+    int64_t cell = firstCell + bit;
+    if (topology == Topology::Torus)
+    {
+      cell = (cell % int64_t(width) + width) % width;
+    }
+    else if (cell < 0 || cell >= int64_t(width))
+    {
+      bit++;
+      continue;
+    }
+
+    // as many cells as the word, the row and the result all have left
+    uint32_t count = std::min({ 64 - uint32_t(cell % 64), uint32_t(width - cell), 64 - bit });
+    uint64_t chunk = row[cell / 64] >> (cell % 64);
+    if (count < 64)
+    {
+      chunk &= (uint64_t(1) << count) - 1;
+    }
+
+    word |= chunk << bit;
+    bit += count;
+  }
+
+  return word;
+}
+
+void CpuEngine::StepTile(TileScratch* scratch, uint32_t firstRow, uint32_t rows, uint32_t firstWord, uint32_t words, uint32_t generations)
+{
+  // the window reaches generations rows beyond the tile and one word to either side,
+  // plus a word on both ends that stays dead, so StepRow never reads outside of it
+  uint32_t windowRows = rows + 2 * generations;
+  uint32_t windowWords = words + 4;
+  bool torus = topology == Topology::Torus;
+
+  // on the plane the cells beyond the edges are forced dead after every generation, the torus' window simply repeats the board
+  bool masked = !torus && (firstRow < generations || firstRow + rows + generations > height || firstWord == 0 || (uint64_t(firstWord) + words + 1) * 64 > width);
+
+  // window word j holds the cells from (firstWord + j - 2) * 64 on
+  for (uint32_t j = 0; j < windowWords; j++)
+  {
+    int64_t cell = (int64_t(firstWord) + j - 2) * 64;
+    if (j == 0 || j + 1 == windowWords || (!torus && (cell < 0 || cell >= int64_t(width))))
+    {
+      scratch->columnMask[j] = 0;
+    }
+    else
+    {
+      scratch->columnMask[j] = torus || cell + 64 <= int64_t(width) ? ~uint64_t(0) : (uint64_t(1) << (width - cell)) - 1;
+    }
+  }
+
+  for (uint32_t r = 0; r < windowRows; r++)
+  {
+    uint64_t* dst = &scratch->current[size_t(r) * windowWords];
+    scratch->next[size_t(r) * windowWords] = 0;
+    scratch->next[size_t(r + 1) * windowWords - 1] = 0;
+
+    int64_t y = int64_t(firstRow) + r - generations;
+    if (torus)
+    {
+      y = (y % int64_t(height) + height) % height;
+    }
+
+    if (y < 0 || y >= int64_t(height))
+    {
+      scratch->rowMask[r] = 0;
+      std::fill(dst, dst + windowWords, 0);
+      continue;
+    }
+    scratch->rowMask[r] = ~uint64_t(0);
+
+    const uint64_t* src = Row(uint32_t(y));
+    dst[0] = 0;
+    dst[windowWords - 1] = 0;
+    for (uint32_t j = 1; j + 1 < windowWords; j++)
+    {
+      int64_t word = int64_t(firstWord) + j - 2;
+      dst[j] = word >= 0 && (word + 1) * 64 <= int64_t(width) ? src[word] : CellsAt(src, word * 64);
+    }
+  }
+
+  // the trapezoid: every generation is only valid one row and one cell further inside than the one before
+  uint64_t* current = scratch->current.data();
+  uint64_t* result = scratch->next.data();
+  for (uint32_t s = 1; s <= generations; s++)
+  {
+    for (uint32_t r = s; r < windowRows - s; r++)
+    {
+      const uint64_t* up = current + size_t(r - 1) * windowWords;
+      const uint64_t* row = current + size_t(r) * windowWords;
+      const uint64_t* down = current + size_t(r + 1) * windowWords;
+      uint64_t* out = result + size_t(r) * windowWords;
+
+      StepRow(up, row, down, out, 1, windowWords - 1);
+
+      if (masked)
+      {
+        uint64_t rowMask = scratch->rowMask[r];
+        for (uint32_t j = 1; j + 1 < windowWords; j++)
+        {
+          out[j] &= scratch->columnMask[j] & rowMask;
+        }
+      }
+    }
+
+    std::swap(current, result);
+  }
+
+  for (uint32_t r = 0; r < rows; r++)
+  {
+    const uint64_t* src = current + size_t(r + generations) * windowWords + 2;
+    uint64_t* dst = &next[size_t(firstRow + r + 1) * stride + 1 + firstWord];
+
+    std::copy(src, src + words, dst);
+    if (firstWord + words == wordsPerRow)
+    {
+      dst[words - 1] &= lastWordMask;
+    }
+  }
+}
+
+void CpuEngine::StepBlocked(uint32_t generations)
+{
+  PROFILE_SCOPE("cpu blocked step");
+
+  uint32_t tileRows = (height + TILE_ROWS - 1) / TILE_ROWS;
+  uint32_t tileColumns = (wordsPerRow + TILE_WORDS - 1) / TILE_WORDS;
+  uint32_t tileCount = tileRows * tileColumns;
+  uint32_t threadCount = ThreadCount(tileCount);
+
+  size_t windowRows = TILE_ROWS + 2 * TEMPORAL_BLOCK;
+  size_t windowWords = TILE_WORDS + 4;
+  scratches.resize(threadCount);
+  for (auto& scratch : scratches)
+  {
+    scratch.current.resize(windowRows * windowWords);
+    scratch.next.resize(windowRows * windowWords);
+    scratch.columnMask.resize(windowWords);
+    scratch.rowMask.resize(windowRows);
+  }
+
+  while (generations > 0)
+  {
+    uint32_t block = std::min(generations, TEMPORAL_BLOCK);
+
+    // every tile reads the old board and writes its own part of the new one
+    auto stepTiles = [&](uint32_t thread)
+    {
+      for (uint32_t t = thread; t < tileCount; t += threadCount)
+      {
+        uint32_t y = t / tileColumns * TILE_ROWS;
+        uint32_t x = t % tileColumns * TILE_WORDS;
+        StepTile(&scratches[thread], y, std::min(TILE_ROWS, height - y), x, std::min(TILE_WORDS, wordsPerRow - x), block);
+      }
+    };
+
+    ForEachThread(threadCount, stepTiles);
+
+    cells.swap(next);
+    generations -= block;
+  }
+}
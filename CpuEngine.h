@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Structs.h"
+#include "Board.h"
+
+// Bit parallel B3/S23 on the host, 64 cells per word.
+// Every row carries a halo word on both sides and the board a halo row above and below.
+// The halo is filled once per step according to the topology, so the inner loop never
+// checks for edges: zeros for the plane, the opposite edge for the torus.
+// The rows above and below may also come from elsewhere, when the board is only a strip of a larger one.
+class CpuEngine
+{
+public:
+  // generations StepBlocked advances per pass, at most 64 since a tile's halo is one word wide
+  static constexpr uint32_t TEMPORAL_BLOCK = 16;
+
+private:
+  // a tile with its halo, in both buffers, stays inside L2 and the halo costs about a tenth extra
+  static constexpr uint32_t TILE_ROWS = 256;
+  static constexpr uint32_t TILE_WORDS = 64;
+
+  struct TileScratch
+  {
+    std::vector<uint64_t> current;
+    std::vector<uint64_t> next;
+    std::vector<uint64_t> columnMask;
+    std::vector<uint64_t> rowMask;
+  };
+
+  uint32_t width;
+  uint32_t height;
+  uint32_t wordsPerRow;
+  uint32_t stride;
+  uint64_t lastWordMask;
+  Topology topology;
+
+  std::vector<uint64_t> cells;
+  std::vector<uint64_t> next;
+
+  // one per thread of StepBlocked
+  std::vector<TileScratch> scratches;
+
+  void CopyHalo(const uint64_t* above, const uint64_t* below);
+
+  // the 64 cells from firstCell on, wrapped around or dead beyond the edges according to the topology
+  uint64_t CellsAt(const uint64_t* row, int64_t firstCell) const;
+  void StepTile(TileScratch* scratch, uint32_t firstRow, uint32_t rows, uint32_t firstWord, uint32_t words, uint32_t generations);
+
+public:
+  CpuEngine(uint32_t width, uint32_t height, Topology topology);
+
+  void SetBoard(const PackedBoard& board);
+  PackedBoard GetBoard() const;
+
+  // WordsPerRow words, for boards that never exist as a whole PackedBoard
+  void SetRow(uint32_t y, const uint64_t* words);
+
+  // cells outside the board are ignored
+  void SetCell(uint32_t x, uint32_t y, bool alive);
+
+  uint32_t Height() const { return height; }
+  uint32_t WordsPerRow() const { return wordsPerRow; }
+  const uint64_t* Row(uint32_t y) const { return &cells[size_t(y + 1) * stride + 1]; }
+  uint64_t CountCells() const;
+
+  void Step();
+
+  // above and below are rows of WordsPerRow words, nullptr for dead cells
+  void Step(const uint64_t* above, const uint64_t* below);
+
+  // same as that many Step(), but temporally blocked: every tile is loaded with a halo of TEMPORAL_BLOCK cells,
+  // advanced that many generations on a shrinking trapezoid while it is in cache and written back once,
+  // so the board streams through memory once per block instead of once per generation.
+  // The tiles don't depend on each other and are spread over all cores
+  void StepBlocked(uint32_t generations);
+};
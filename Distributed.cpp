@@ -0,0 +1,527 @@
+#include "Distributed.h"
+#include "CpuEngine.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+using boost::asio::ip::tcp;
+
+namespace
+{
+  enum class MessageType : uint32_t
+  {
+    Join,
+    Assignment,
+    Continue,
+    Report,
+    Board
+  };
+
+  enum class Command : uint32_t
+  {
+    Stop,
+    Step,
+    // a step whose report carries the population, counting is another full pass over the strip
+    StepAndCount,
+    SendBoard
+  };
+
+  // every how many generations the coordinator asks for the population, besides the last one
+  constexpr uint32_t COUNT_INTERVAL = 100;
+
+  // integers travel in host byte order, the nodes of one cluster share it
+  struct Message
+  {
+    std::vector<uint8_t> data;
+    size_t position = 0;
+
+    template<typename T>
+    void Put(const T& value)
+    {
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+      data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void PutWords(const uint64_t* words, size_t count)
+    {
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(words);
+      data.insert(data.end(), bytes, bytes + count * sizeof(uint64_t));
+    }
+
+    void PutString(const std::string& value)
+    {
+      Put(uint32_t(value.size()));
+      data.insert(data.end(), value.begin(), value.end());
+    }
+
+    void Take(void* destination, size_t size)
+    {
+      if (position + size > data.size())
+      {
+        throw std::runtime_error("truncated message");
+      }
+
+      memcpy(destination, &data[position], size);
+      position += size;
+    }
+
+    template<typename T>
+    T Get()
+    {
+      T value;
+      Take(&value, sizeof(T));
+      return value;
+    }
+
+    void GetWords(uint64_t* words, size_t count)
+    {
+      Take(words, count * sizeof(uint64_t));
+    }
+
+    std::string GetString()
+    {
+      std::string value(Get<uint32_t>(), '\0');
+      Take(&value[0], value.size());
+      return value;
+    }
+
+    void Expect(MessageType type)
+    {
+      if (Get<MessageType>() != type)
+      {
+        throw std::runtime_error("unexpected message");
+      }
+    }
+  };
+
+  void Send(tcp::socket& socket, const Message& message)
+  {
+    uint32_t size = uint32_t(message.data.size());
+    std::array<boost::asio::const_buffer, 2> buffers = { boost::asio::buffer(&size, sizeof(size)), boost::asio::buffer(message.data) };
+    boost::asio::write(socket, buffers);
+  }
+
+  Message Receive(tcp::socket& socket)
+  {
+    uint32_t size;
+    boost::asio::read(socket, boost::asio::buffer(&size, sizeof(size)));
+
+    Message message;
+    message.data.resize(size);
+    boost::asio::read(socket, boost::asio::buffer(message.data));
+    return message;
+  }
+
+  // The connection to one neighbour. Both ends remember the last row that went over it,
+  // so a row is sent as the words that changed, or whole when that is smaller.
+  struct HaloLink
+  {
+    tcp::socket socket;
+    std::vector<uint64_t> sent;
+    std::vector<uint64_t> received;
+
+    std::vector<uint8_t> sendData;
+    uint32_t receiveSize;
+    Message receiveMessage;
+
+    HaloLink(boost::asio::io_context& io, uint32_t wordsPerRow) : socket(io), sent(wordsPerRow), received(wordsPerRow)
+    {
+
+    }
+
+    void Encode(const uint64_t* row)
+    {
+      std::vector<uint32_t> changed;
+      for (uint32_t i = 0; i < sent.size(); i++)
+      {
+        if (row[i] != sent[i])
+        {
+          changed.push_back(i);
+        }
+      }
+
+      Message message;
+      if (changed.size() * (sizeof(uint32_t) + sizeof(uint64_t)) < sent.size() * sizeof(uint64_t))
+      {
+        message.Put(uint32_t(1));
+        message.Put(uint32_t(changed.size()));
+        for (auto index : changed)
+        {
+          message.Put(index);
+          message.Put(row[index]);
+        }
+      }
+      else
+      {
+        message.Put(uint32_t(0));
+        message.PutWords(row, sent.size());
+      }
+
+      std::copy(row, row + sent.size(), sent.begin());
+
+      uint32_t size = uint32_t(message.data.size());
+      sendData.resize(sizeof(size));
+      memcpy(sendData.data(), &size, sizeof(size));
+      sendData.insert(sendData.end(), message.data.begin(), message.data.end());
+    }
+
+    void Decode()
+    {
+      Message& message = receiveMessage;
+
+      if (message.Get<uint32_t>() == 1)
+      {
+        uint32_t count = message.Get<uint32_t>();
+        for (uint32_t i = 0; i < count; i++)
+        {
+          uint32_t index = message.Get<uint32_t>();
+          if (index >= received.size())
+          {
+            throw std::runtime_error("halo word out of range");
+          }
+
+          received[index] = message.Get<uint64_t>();
+        }
+      }
+      else
+      {
+        message.GetWords(received.data(), received.size());
+      }
+    }
+  };
+
+  // sends rows[i] over links[i] and receives the neighbour's row into links[i]->received,
+  // all at once so two neighbours writing large rows to each other cannot deadlock
+  void ExchangeRows(boost::asio::io_context& io, const std::vector<HaloLink*>& links, const std::vector<const uint64_t*>& rows)
+  {
+    boost::system::error_code error;
+    auto check = [&error](const boost::system::error_code& ec)
+    {
+      if (ec && !error)
+      {
+        error = ec;
+      }
+    };
+
+    for (size_t i = 0; i < links.size(); i++)
+    {
+      HaloLink* link = links[i];
+      link->Encode(rows[i]);
+
+      boost::asio::async_write(link->socket, boost::asio::buffer(link->sendData), [check](const boost::system::error_code& ec, size_t) { check(ec); });
+
+      boost::asio::async_read(link->socket, boost::asio::buffer(&link->receiveSize, sizeof(link->receiveSize)), [link, check](const boost::system::error_code& ec, size_t)
+      {
+        if (ec)
+        {
+          check(ec);
+          return;
+        }
+
+        link->receiveMessage = Message();
+        link->receiveMessage.data.resize(link->receiveSize);
+        boost::asio::async_read(link->socket, boost::asio::buffer(link->receiveMessage.data), [check](const boost::system::error_code& ec, size_t) { check(ec); });
+      });
+    }
+
+    io.restart();
+    io.run();
+
+    if (error)
+    {
+      throw boost::system::system_error(error);
+    }
+
+    for (auto link : links)
+    {
+      link->Decode();
+    }
+  }
+}
+
+bool RunCoordinator(const Settings& settings, PackedBoard* board)
+{
+  try
+  {
+    uint32_t count = settings.coordinate;
+    if (count > settings.imageHeight)
+    {
+      std::cout << "more workers than rows" << std::endl;
+      return false;
+    }
+
+    boost::asio::io_context io;
+    tcp::acceptor acceptor(io, tcp::endpoint(tcp::v4(), uint16_t(settings.port)));
+    std::cout << "waiting for " << count << " workers on port " << acceptor.local_endpoint().port() << std::endl;
+
+    // workers are reachable under the address they connected from and the port they listen on
+    std::vector<tcp::socket> workers;
+    std::vector<std::pair<std::string, uint16_t>> peers;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      workers.emplace_back(acceptor.accept());
+
+      Message join = Receive(workers.back());
+      join.Expect(MessageType::Join);
+      peers.push_back({ workers.back().remote_endpoint().address().to_string(), join.Get<uint16_t>() });
+
+      std::cout << "worker " << i << " joined from " << peers.back().first << ":" << peers.back().second << std::endl;
+    }
+
+    // same split as the strips of a StripEngine
+    std::vector<uint32_t> firstRows(count + 1, 0);
+    for (uint32_t i = 0; i < count; i++)
+    {
+      firstRows[i + 1] = firstRows[i] + settings.imageHeight / count + (i < settings.imageHeight % count ? 1 : 0);
+    }
+
+    std::vector<std::vector<Position>> seeds(count);
+    for (auto& pos : settings.positions)
+    {
+      if (pos.x < settings.imageWidth && pos.y < settings.imageHeight)
+      {
+        uint32_t strip = uint32_t(std::upper_bound(firstRows.begin(), firstRows.end(), pos.y) - firstRows.begin()) - 1;
+        seeds[strip].push_back(pos);
+      }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+      Message assignment;
+      assignment.Put(MessageType::Assignment);
+      assignment.Put(i);
+      assignment.Put(count);
+      assignment.Put(settings.imageWidth);
+      assignment.Put(firstRows[i]);
+      assignment.Put(firstRows[i + 1] - firstRows[i]);
+      assignment.Put(settings.topology);
+
+      for (auto& peer : peers)
+      {
+        assignment.PutString(peer.first);
+        assignment.Put(peer.second);
+      }
+
+      // every worker draws its part of the soup itself, the generator only depends on the cell position
+      assignment.Put(settings.density);
+      assignment.Put(settings.seed);
+      assignment.Put(uint64_t(seeds[i].size()));
+      for (auto& pos : seeds[i])
+      {
+        assignment.Put(pos);
+      }
+
+      Send(workers[i], assignment);
+    }
+
+    // every generation is a barrier: all workers step, report and wait for the next go
+    auto start = std::chrono::steady_clock::now();
+    uint64_t alive = 0;
+    for (uint32_t generation = 1; generation <= settings.generations; generation++)
+    {
+      bool counting = generation % COUNT_INTERVAL == 0 || generation == settings.generations;
+
+      Message go;
+      go.Put(MessageType::Continue);
+      go.Put(counting ? Command::StepAndCount : Command::Step);
+      for (auto& worker : workers)
+      {
+        Send(worker, go);
+      }
+
+      alive = 0;
+      for (auto& worker : workers)
+      {
+        Message report = Receive(worker);
+        report.Expect(MessageType::Report);
+        alive += counting ? report.Get<uint64_t>() : 0;
+      }
+
+      if (generation % COUNT_INTERVAL == 0)
+      {
+        std::cout << "generation " << generation << ": " << alive << " cells alive" << std::endl;
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << settings.generations << " generations on " << count << " workers: " << settings.generations / elapsed.count() << " generations/s, " << alive << " cells alive" << std::endl;
+
+    Message stop;
+    stop.Put(MessageType::Continue);
+    stop.Put(board ? Command::SendBoard : Command::Stop);
+    for (auto& worker : workers)
+    {
+      Send(worker, stop);
+    }
+
+    if (board)
+    {
+      *board = CreatePackedBoard(settings.imageWidth, settings.imageHeight);
+
+      for (uint32_t i = 0; i < count; i++)
+      {
+        Message strip = Receive(workers[i]);
+        strip.Expect(MessageType::Board);
+        strip.GetWords(&board->words[size_t(firstRows[i]) * board->wordsPerRow], size_t(firstRows[i + 1] - firstRows[i]) * board->wordsPerRow);
+      }
+    }
+
+    return true;
+  }
+  catch (const std::exception& e)
+  {
+    std::cout << "coordinator: " << e.what() << std::endl;
+    return false;
+  }
+}
+
+bool RunWorker(const Settings& settings)
+{
+  try
+  {
+    size_t colon = settings.join.rfind(':');
+    if (colon == std::string::npos)
+    {
+      std::cout << "--Join expects host:port" << std::endl;
+      return false;
+    }
+
+    boost::asio::io_context io;
+    tcp::resolver resolver(io);
+
+    // listening before joining, so the neighbours can connect as soon as they know about this worker
+    tcp::acceptor acceptor(io, tcp::endpoint(tcp::v4(), uint16_t(settings.port)));
+
+    tcp::socket coordinator(io);
+    boost::asio::connect(coordinator, resolver.resolve(settings.join.substr(0, colon), settings.join.substr(colon + 1)));
+
+    Message join;
+    join.Put(MessageType::Join);
+    join.Put(acceptor.local_endpoint().port());
+    Send(coordinator, join);
+
+    Message assignment = Receive(coordinator);
+    assignment.Expect(MessageType::Assignment);
+    uint32_t rank = assignment.Get<uint32_t>();
+    uint32_t count = assignment.Get<uint32_t>();
+    uint32_t width = assignment.Get<uint32_t>();
+    uint32_t firstRow = assignment.Get<uint32_t>();
+    uint32_t rows = assignment.Get<uint32_t>();
+    Topology topology = assignment.Get<Topology>();
+
+    std::vector<std::pair<std::string, uint16_t>> peers;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      std::string address = assignment.GetString();
+      peers.push_back({ address, assignment.Get<uint16_t>() });
+    }
+
+    double density = assignment.Get<double>();
+    uint64_t seed = assignment.Get<uint64_t>();
+
+    PackedBoard strip = RandomBoard(width, rows, density, seed, firstRow);
+    uint64_t seedCount = assignment.Get<uint64_t>();
+    for (uint64_t i = 0; i < seedCount; i++)
+    {
+      Position pos = assignment.Get<Position>();
+      SetCell(&strip, pos.x, pos.y - firstRow, true);
+    }
+
+    // the torus only wraps columns inside the engine, the rows above and below come from the neighbours
+    CpuEngine engine(width, rows, topology);
+    engine.SetBoard(strip);
+
+    std::cout << "worker " << rank << " of " << count << ": rows " << firstRow << " to " << firstRow + rows - 1 << std::endl;
+
+    bool wrap = topology == Topology::Torus;
+    bool hasAbove = count > 1 && (rank > 0 || wrap);
+    bool hasBelow = count > 1 && (rank + 1 < count || wrap);
+
+    // every worker connects to the one below and accepts the one above
+    HaloLink above(io, engine.WordsPerRow());
+    HaloLink below(io, engine.WordsPerRow());
+
+    if (hasBelow)
+    {
+      auto& peer = peers[(rank + 1) % count];
+      below.socket.connect(tcp::endpoint(boost::asio::ip::make_address(peer.first), peer.second));
+      below.socket.set_option(tcp::no_delay(true));
+    }
+
+    if (hasAbove)
+    {
+      acceptor.accept(above.socket);
+      above.socket.set_option(tcp::no_delay(true));
+    }
+
+    while (true)
+    {
+      Message go = Receive(coordinator);
+      go.Expect(MessageType::Continue);
+      Command command = go.Get<Command>();
+
+      if (command == Command::SendBoard)
+      {
+        strip = engine.GetBoard();
+
+        Message board;
+        board.Put(MessageType::Board);
+        board.PutWords(strip.words.data(), strip.words.size());
+        Send(coordinator, board);
+      }
+
+      if (command != Command::Step && command != Command::StepAndCount)
+      {
+        break;
+      }
+
+      std::vector<HaloLink*> links;
+      std::vector<const uint64_t*> rowsToSend;
+      if (hasAbove)
+      {
+        links.push_back(&above);
+        rowsToSend.push_back(engine.Row(0));
+      }
+
+      if (hasBelow)
+      {
+        links.push_back(&below);
+        rowsToSend.push_back(engine.Row(rows - 1));
+      }
+
+      ExchangeRows(io, links, rowsToSend);
+
+      if (count == 1)
+      {
+        engine.Step();
+      }
+      else
+      {
+        engine.Step(hasAbove ? above.received.data() : nullptr, hasBelow ? below.received.data() : nullptr);
+      }
+
+      // a bare acknowledgement unless the coordinator asked for the population
+      Message report;
+      report.Put(MessageType::Report);
+      if (command == Command::StepAndCount)
+      {
+        report.Put(engine.CountCells());
+      }
+      Send(coordinator, report);
+    }
+
+    return true;
+  }
+  catch (const std::exception& e)
+  {
+    std::cout << "worker: " << e.what() << std::endl;
+    return false;
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Structs.h"
+#include "Board.h"
+
+// Runs a board too large for one machine as horizontal strips in several processes.
+// The coordinator hands out the strips and the seed, then counts generations: every worker
+// acknowledges each step and only continues once the coordinator says so, the populations
+// are only counted and reported every hundred generations and after the last one.
+// Workers exchange their first and last row directly with their neighbours over TCP,
+// sending only the words that changed since the previous generation.
+
+// listens on settings.port until settings.coordinate workers joined, then runs settings.generations steps,
+// gathers the whole board afterwards if board is not nullptr
+bool RunCoordinator(const Settings& settings, PackedBoard* board);
+
+// joins the coordinator at settings.join (host:port)
+bool RunWorker(const Settings& settings);
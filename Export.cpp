@@ -0,0 +1,221 @@
+#include "Export.h"
+#include "Profile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <boost/crc.hpp>
+
+constexpr size_t MAX_PENDING_EXPORTS = 4;
+
+// deflate stored blocks carry at most this many bytes
+constexpr size_t STORED_BLOCK_SIZE = 65535;
+
+static void WriteBigEndian(uint32_t value, std::vector<uint8_t>* out)
+{
+  out->push_back(uint8_t(value >> 24));
+  out->push_back(uint8_t(value >> 16));
+  out->push_back(uint8_t(value >> 8));
+  out->push_back(uint8_t(value));
+}
+
+static void WriteChunk(const char* type, const std::vector<uint8_t>& data, std::vector<uint8_t>* out)
+{
+  WriteBigEndian(uint32_t(data.size()), out);
+
+  size_t start = out->size();
+  out->insert(out->end(), type, type + 4);
+  out->insert(out->end(), data.begin(), data.end());
+
+  boost::crc_32_type crc;
+  crc.process_bytes(out->data() + start, out->size() - start);
+  WriteBigEndian(crc.checksum(), out);
+}
+
+// a zlib stream of stored blocks: the rows are 1 bit per cell already, compressing them is left to the tools reading them
+static std::vector<uint8_t> StoreZlib(const std::vector<uint8_t>& data)
+{
+  std::vector<uint8_t> out = { 0x78, 0x01 };
+  out.reserve(data.size() + data.size() / STORED_BLOCK_SIZE * 5 + 16);
+
+  size_t offset = 0;
+  do
+  {
+    size_t length = std::min(STORED_BLOCK_SIZE, data.size() - offset);
+    bool last = offset + length == data.size();
+
+    out.push_back(last ? 1 : 0);
+    out.push_back(uint8_t(length));
+    out.push_back(uint8_t(length >> 8));
+    out.push_back(uint8_t(~length));
+    out.push_back(uint8_t(~length >> 8));
+    out.insert(out.end(), data.begin() + offset, data.begin() + offset + length);
+
+    offset += length;
+  } while (offset < data.size());
+
+  // adler32, reduced every 5552 bytes, the most that cannot overflow 32 bits
+  uint32_t a = 1, b = 0;
+  for (size_t i = 0; i < data.size(); i += 5552)
+  {
+    size_t end = std::min(i + 5552, data.size());
+    for (size_t j = i; j < end; j++)
+    {
+      a += data[j];
+      b += a;
+    }
+
+    a %= 65521;
+    b %= 65521;
+  }
+
+  WriteBigEndian((b << 16) | a, &out);
+  return out;
+}
+
+static uint8_t ReverseBits(uint8_t byte)
+{
+  byte = uint8_t((byte & 0xF0) >> 4 | (byte & 0x0F) << 4);
+  byte = uint8_t((byte & 0xCC) >> 2 | (byte & 0x33) << 2);
+  byte = uint8_t((byte & 0xAA) >> 1 | (byte & 0x55) << 1);
+  return byte;
+}
+
+BoardExporter::BoardExporter(const std::string& path, ExportFormat format, uint32_t frameRate)
+  : path(path), format(format), frameRate(frameRate), width(0), height(0), failed(false),
+  pending("export", true, [this](std::pair<uint64_t, PackedBoard>&& frame) { Export(frame.first, frame.second); })
+{
+}
+
+void BoardExporter::Write(uint64_t generation, PackedBoard&& board)
+{
+  pending.Push({ generation, std::move(board) });
+}
+
+bool BoardExporter::Ready()
+{
+  return pending.Pending() < MAX_PENDING_EXPORTS;
+}
+
+void BoardExporter::Export(uint64_t generation, const PackedBoard& board)
+{
+  PROFILE_SCOPE("export");
+
+  if (!failed && !Store(generation, board))
+  {
+    std::cout << "could not export generation " << generation << " to " << path << std::endl;
+    failed = true;
+  }
+}
+
+bool BoardExporter::Store(uint64_t generation, const PackedBoard& board)
+{
+  // the streams are opened with the first board, which also fixes the size
+  if (width == 0 && height == 0)
+  {
+    width = board.width;
+    height = board.height;
+
+    if (format != ExportFormat::Png)
+    {
+      stream.open(path, std::ios::binary | std::ios::trunc);
+      if (!stream.is_open())
+      {
+        return false;
+      }
+
+      if (format == ExportFormat::Y4m)
+      {
+        stream << "YUV4MPEG2 W" << width << " H" << height << " F" << frameRate << ":1 Ip A1:1 Cmono\n";
+      }
+      else
+      {
+        uint32_t header[4] = { PACKED_MAGIC, width, height, board.wordsPerRow };
+        stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+      }
+    }
+  }
+
+  if (board.width != width || board.height != height)
+  {
+    return false;
+  }
+
+  switch (format)
+  {
+  case ExportFormat::Png:
+    return StorePng(generation, board);
+  case ExportFormat::Y4m:
+    return StoreY4m(board);
+  case ExportFormat::Packed:
+    return StorePacked(generation, board);
+  }
+
+  return false;
+}
+
+bool BoardExporter::StorePng(uint64_t generation, const PackedBoard& board)
+{
+  static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+  // every row starts with filter type 0, then the cells most significant bit first
+  size_t rowBytes = (size_t(width) + 7) / 8;
+  std::vector<uint8_t> rows((rowBytes + 1) * height);
+
+  for (uint32_t y = 0; y < height; y++)
+  {
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(&board.words[size_t(y) * board.wordsPerRow]);
+    uint8_t* dst = &rows[(rowBytes + 1) * y];
+
+    dst[0] = 0;
+    for (size_t i = 0; i < rowBytes; i++)
+    {
+      dst[i + 1] = ReverseBits(src[i]);
+    }
+  }
+
+  std::vector<uint8_t> header;
+  WriteBigEndian(width, &header);
+  WriteBigEndian(height, &header);
+  header.insert(header.end(), { 1, 0, 0, 0, 0 }); // 1 bit grayscale, deflate, no filtering, no interlace
+
+  std::vector<uint8_t> png(signature, signature + sizeof(signature));
+  WriteChunk("IHDR", header, &png);
+  WriteChunk("IDAT", StoreZlib(rows), &png);
+  WriteChunk("IEND", {}, &png);
+
+  std::ostringstream fileName;
+  fileName << path << "_" << std::setw(6) << std::setfill('0') << generation << ".png";
+
+  std::ofstream file(fileName.str(), std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(png.data()), png.size());
+  return bool(file);
+}
+
+bool BoardExporter::StoreY4m(const PackedBoard& board)
+{
+  std::vector<uint8_t> luma(size_t(width) * height);
+  for (uint32_t y = 0; y < height; y++)
+  {
+    const uint64_t* row = &board.words[size_t(y) * board.wordsPerRow];
+    for (uint32_t x = 0; x < width; x++)
+    {
+      luma[size_t(y) * width + x] = (row[x / 64] >> (x % 64)) & 1 ? 255 : 0;
+    }
+  }
+
+  stream << "FRAME\n";
+  stream.write(reinterpret_cast<const char*>(luma.data()), luma.size());
+  return bool(stream);
+}
+
+bool BoardExporter::StorePacked(uint64_t generation, const PackedBoard& board)
+{
+  stream.write(reinterpret_cast<const char*>(&generation), sizeof(generation));
+  stream.write(reinterpret_cast<const char*>(board.words.data()), board.words.size() * sizeof(uint64_t));
+  return bool(stream);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "Structs.h"
+#include "Board.h"
+#include "BackgroundQueue.h"
+
+constexpr uint32_t PACKED_MAGIC = 0x4B504F47; // "GOPK"
+
+// Writes boards to disk on a background thread, so neither stepping nor presenting waits for I/O.
+// png: one 1 bit grayscale image per board, named <path>_<generation>.png
+// y4m: a single 8 bit monochrome YUV4MPEG2 stream, as understood by ffmpeg and most players
+// packed: a single file of a header (magic, width, height, words per row) and frames of
+//         the generation followed by the PackedBoard words
+class BoardExporter
+{
+private:
+  std::string path;
+  ExportFormat format;
+  uint32_t frameRate;
+
+  // owned by the worker
+  std::ofstream stream;
+  uint32_t width;
+  uint32_t height;
+
+  std::atomic<bool> failed;
+
+  // handed over by Write, last so the worker is done before anything above goes away
+  BackgroundQueue<std::pair<uint64_t, PackedBoard>> pending;
+
+  void Export(uint64_t generation, const PackedBoard& board);
+  bool Store(uint64_t generation, const PackedBoard& board);
+  bool StorePng(uint64_t generation, const PackedBoard& board);
+  bool StoreY4m(const PackedBoard& board);
+  bool StorePacked(uint64_t generation, const PackedBoard& board);
+
+public:
+  BoardExporter(const std::string& path, ExportFormat format, uint32_t frameRate);
+  // writes everything still pending before returning
+  ~BoardExporter() = default;
+
+  BoardExporter(const BoardExporter& exporter) = delete;
+  BoardExporter& operator=(const BoardExporter& exporter) = delete;
+
+  // never drops a board, callers hold back new ones while the writer is not Ready()
+  void Write(uint64_t generation, PackedBoard&& board);
+  bool Ready();
+  bool Failed() const { return failed; }
+};
@@ -0,0 +1,145 @@
+#include "FrameScheduler.h"
+#include "GameOfLifeVulkan.h"
+
+#include <algorithm>
+
+VkResult FrameScheduler::Create(VkDevice device, uint32_t framesInFlight, uint32_t runAhead, bool throughput)
+{
+  this->device = device;
+  this->runAhead = std::max(runAhead, 1u);
+  this->throughput = throughput;
+
+  submittedGeneration = 0;
+  presentedGeneration = 0;
+  frame = 0;
+
+  auto timelineCreation = CreateTimelineSemaphore(device, 0);
+  if (std::holds_alternative<VkResult>(timelineCreation))
+  {
+    return std::get<VkResult>(timelineCreation);
+  }
+  generationTimeline = std::get<VkSemaphore>(timelineCreation);
+
+  timelineCreation = CreateTimelineSemaphore(device, 0);
+  if (std::holds_alternative<VkResult>(timelineCreation))
+  {
+    return std::get<VkResult>(timelineCreation);
+  }
+  renderTimeline = std::get<VkSemaphore>(timelineCreation);
+
+  // the presented generation, up to runAhead generations in flight and the one being written
+  slotReadFrame = std::vector<std::atomic<uint64_t>>(this->runAhead + 2);
+  for (auto& readFrame : slotReadFrame)
+  {
+    readFrame.store(0);
+  }
+
+  frames.resize(framesInFlight);
+  for (auto& f : frames)
+  {
+    auto semaphoreCreation = CreateBinarySemaphore(device);
+    if (std::holds_alternative<VkResult>(semaphoreCreation))
+    {
+      return std::get<VkResult>(semaphoreCreation);
+    }
+    f.imageAvailable = std::get<VkSemaphore>(semaphoreCreation);
+
+    semaphoreCreation = CreateBinarySemaphore(device);
+    if (std::holds_alternative<VkResult>(semaphoreCreation))
+    {
+      return std::get<VkResult>(semaphoreCreation);
+    }
+    f.renderFinished = std::get<VkSemaphore>(semaphoreCreation);
+  }
+
+  return VK_SUCCESS;
+}
+
+void FrameScheduler::Destroy()
+{
+  for (auto& f : frames)
+  {
+    vkDestroySemaphore(device, f.renderFinished, nullptr);
+    vkDestroySemaphore(device, f.imageAvailable, nullptr);
+  }
+
+  vkDestroySemaphore(device, renderTimeline, nullptr);
+  vkDestroySemaphore(device, generationTimeline, nullptr);
+}
+
+uint64_t FrameScheduler::CompletedGeneration() const
+{
+  uint64_t value = 0;
+  vkGetSemaphoreCounterValue(device, generationTimeline, &value);
+
+  return value;
+}
+
+uint64_t FrameScheduler::BeginGeneration(std::vector<SemaphoreSubmit>* waits, VkPipelineStageFlags stage)
+{
+  uint64_t generation = ++submittedGeneration;
+  uint32_t slot = Slot(generation);
+
+  // the previous generation has to be complete (it is read, and timeline values must be signaled in order)
+  // and the last frame sampling the target slot has to be done with it
+  waits->push_back({ generationTimeline, generation - 1, stage });
+  // (sequentially consistent against PinGeneration: either the step sees the pin, or the frame sees the step)
+  waits->push_back({ renderTimeline, slotReadFrame[slot].load(std::memory_order_seq_cst), stage });
+
+  return generation;
+}
+
+SemaphoreSubmit FrameScheduler::EndGeneration(uint64_t generation) const
+{
+  return { generationTimeline, generation, 0 };
+}
+
+VkResult FrameScheduler::WaitForGeneration(uint64_t generation, uint64_t timeout) const
+{
+  return WaitTimelineSemaphore(device, generationTimeline, generation, timeout);
+}
+
+uint32_t FrameScheduler::BeginFrame()
+{
+  // reusing the semaphores and command buffer of frame f - framesInFlight
+  if (frame >= frames.size())
+  {
+    WaitTimelineSemaphore(device, renderTimeline, frame + 1 - frames.size(), UINT64_MAX);
+  }
+
+  return uint32_t(frame % frames.size());
+}
+
+std::vector<SemaphoreSubmit> FrameScheduler::FrameWaits(uint32_t frameIndex, uint64_t generation) const
+{
+  return
+  {
+    { frames[frameIndex].imageAvailable, 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT },
+    { generationTimeline, generation, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT }
+  };
+}
+
+std::vector<SemaphoreSubmit> FrameScheduler::FrameSignals(uint32_t frameIndex) const
+{
+  return
+  {
+    { frames[frameIndex].renderFinished, 0, 0 },
+    { renderTimeline, frame + 1, 0 }
+  };
+}
+
+bool FrameScheduler::PinGeneration(uint64_t generation)
+{
+  // the frame about to be recorded signals frame + 1 once it stopped sampling
+  slotReadFrame[Slot(generation)].store(frame + 1, std::memory_order_seq_cst);
+  return submittedGeneration.load(std::memory_order_seq_cst) < generation + SlotCount();
+}
+
+void FrameScheduler::EndFrame(uint64_t generation)
+{
+  frame++;
+
+  // released together with the presented generation: a step allowed to run ahead of it also sees the frame reading its slot
+  slotReadFrame[Slot(generation)].store(frame, std::memory_order_relaxed);
+  presentedGeneration.store(generation, std::memory_order_release);
+}
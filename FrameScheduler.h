@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Structs.h"
+
+// Orders simulation steps and present frames with two timeline semaphores:
+// the generation timeline reaches value g once generation g is written,
+// the render timeline reaches value f once present frame f stopped sampling its board image.
+// In throughput mode steps only run ahead of the GPU, not of the frames: a frame pins the
+// generation it samples, and a step lapping the slot ring waits on the GPU for that frame alone.
+class FrameScheduler
+{
+private:
+  struct Frame
+  {
+    VkSemaphore imageAvailable;
+    VkSemaphore renderFinished;
+  };
+
+  VkDevice device;
+
+  VkSemaphore generationTimeline;
+  VkSemaphore renderTimeline;
+
+  // the simulation thread owns the generations, the render thread the frames;
+  // the atomics are what one side reads of the other
+  std::atomic<uint64_t> submittedGeneration;
+  std::atomic<uint64_t> presentedGeneration;
+  uint64_t frame;
+
+  uint32_t runAhead;
+  bool throughput;
+  std::vector<std::atomic<uint64_t>> slotReadFrame;
+  std::vector<Frame> frames;
+
+public:
+  FrameScheduler() = default;
+  ~FrameScheduler() = default;
+
+  VkResult Create(VkDevice device, uint32_t framesInFlight, uint32_t runAhead, bool throughput);
+  void Destroy();
+
+  // generation g lives in board image Slot(g), so a step may run ahead without overwriting what is on screen
+  uint32_t SlotCount() const { return uint32_t(slotReadFrame.size()); }
+  uint32_t Slot(uint64_t generation) const { return uint32_t(generation % slotReadFrame.size()); }
+
+  uint64_t SubmittedGeneration() const { return submittedGeneration.load(std::memory_order_relaxed); }
+  uint64_t PresentedGeneration() const { return presentedGeneration.load(std::memory_order_acquire); }
+  uint64_t CompletedGeneration() const;
+  VkSemaphore GenerationTimeline() const { return generationTimeline; }
+
+  bool CanRunAhead() const { return SubmittedGeneration() < (throughput ? CompletedGeneration() : PresentedGeneration()) + runAhead; }
+
+  // hands out the next generation value and the submit dependencies of the step (or upload) writing it
+  uint64_t BeginGeneration(std::vector<SemaphoreSubmit>* waits, VkPipelineStageFlags stage);
+  SemaphoreSubmit EndGeneration(uint64_t generation) const;
+
+  VkResult WaitForGeneration(uint64_t generation, uint64_t timeout = UINT64_MAX) const;
+
+  // frames in flight share a small ring of binary semaphores, the swapchain doesn't take timelines
+  uint32_t BeginFrame();
+  VkSemaphore ImageAvailable(uint32_t frameIndex) const { return frames[frameIndex].imageAvailable; }
+  VkSemaphore RenderFinished(uint32_t frameIndex) const { return frames[frameIndex].renderFinished; }
+  std::vector<SemaphoreSubmit> FrameWaits(uint32_t frameIndex, uint64_t generation) const;
+  std::vector<SemaphoreSubmit> FrameSignals(uint32_t frameIndex) const;
+
+  // before recording the frame, false if a step already reuses the slot of the generation and a newer one has to be shown
+  bool PinGeneration(uint64_t generation);
+  void EndFrame(uint64_t generation);
+};
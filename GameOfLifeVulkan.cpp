@@ -1,7 +1,11 @@
 #include "Structs.h"
 #include "GameOfLifeVulkan.h"
+#include "Profile.h"
 
+#include <algorithm>
 #include <array>
+#include <map>
+#include <mutex>
 #include <set>
 #include <fstream>
 
@@ -272,6 +276,8 @@ VulkanCreation<PhysicalDevice> GetSuitablePhysicalDevice(VkInstance instance, Vk
       // init them to the queue count + 1 so I can check if I got all needed queues
       device.graphicsQueueIndex = queueCount + 1;
       device.presentationQueueIndex = queueCount + 1;
+      device.computeQueueIndex = queueCount + 1;
+      device.transferQueueIndex = queueCount + 1;
 
       int index = 0;
       for (auto queue : queues)
@@ -281,6 +287,17 @@ VulkanCreation<PhysicalDevice> GetSuitablePhysicalDevice(VkInstance instance, Vk
           device.graphicsQueueIndex = index;
         }
 
+        // dedicated families run next to the graphics queue instead of being serialized with it
+        if (queue.queueFlags & VK_QUEUE_COMPUTE_BIT && !(queue.queueFlags & VK_QUEUE_GRAPHICS_BIT) && queue.queueCount > 0)
+        {
+          device.computeQueueIndex = index;
+        }
+
+        if (queue.queueFlags & VK_QUEUE_TRANSFER_BIT && !(queue.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) && queue.queueCount > 0)
+        {
+          device.transferQueueIndex = index;
+        }
+
         VkBool32 presentSupport = false;
         result = vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, index, surface, &presentSupport);
         if (result != VK_SUCCESS)
@@ -296,6 +313,17 @@ VulkanCreation<PhysicalDevice> GetSuitablePhysicalDevice(VkInstance instance, Vk
         index++;
       }
 
+      // no dedicated family: a graphics family always supports compute and transfer as well
+      if (device.computeQueueIndex == queueCount + 1)
+      {
+        device.computeQueueIndex = device.graphicsQueueIndex;
+      }
+
+      if (device.transferQueueIndex == queueCount + 1)
+      {
+        device.transferQueueIndex = device.computeQueueIndex;
+      }
+
       if (device.graphicsQueueIndex != queueCount + 1 &&
         device.presentationQueueIndex != queueCount + 1)
       {
@@ -346,10 +374,10 @@ VulkanCreation<PhysicalDevice> GetSuitablePhysicalDevice(VkInstance instance, Vk
   return nullptr;
 }
 
-VulkanCreation<VkDevice> CreateLogicalDevice(PhysicalDevice physicalDevice, VkPhysicalDeviceFeatures *features)
+VulkanCreation<VkDevice> CreateLogicalDevice(PhysicalDevice physicalDevice, VkPhysicalDeviceFeatures *features, void* featureChain)
 {
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-  std::set<uint32_t> queueIndices = { physicalDevice.graphicsQueueIndex, physicalDevice.presentationQueueIndex };
+  std::set<uint32_t> queueIndices = { physicalDevice.graphicsQueueIndex, physicalDevice.presentationQueueIndex, physicalDevice.computeQueueIndex, physicalDevice.transferQueueIndex };
   float prio = 1.0f;
   for (auto& index : queueIndices)
   {
@@ -364,7 +392,7 @@ VulkanCreation<VkDevice> CreateLogicalDevice(PhysicalDevice physicalDevice, VkPh
 
   VkDeviceCreateInfo createInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
   createInfo.flags = 0;
-  createInfo.pNext = 0;
+  createInfo.pNext = featureChain;
   createInfo.queueCreateInfoCount = uint32_t(queueCreateInfos.size());
   createInfo.pQueueCreateInfos = queueCreateInfos.data();
   createInfo.enabledExtensionCount = uint32_t(physicalDevice.supportedExtensions.size());
@@ -383,13 +411,153 @@ VulkanCreation<VkDevice> CreateLogicalDevice(PhysicalDevice physicalDevice, VkPh
   return device;
 }
 
-VulkanCreation<Swapchain> CreateSwapchain(PhysicalDevice physicalDevice, VkSurfaceKHR surface, VkDevice device, VkExtent2D defaultExtent)
+VulkanCreation<std::vector<PhysicalDevice>> GetComputePhysicalDevices(VkInstance instance, const std::vector<const char*>& requiredExtensions)
+{
+  uint32_t count;
+  std::vector<VkPhysicalDevice> physicalDevices;
+  VkResult result = vkEnumeratePhysicalDevices(instance, &count, nullptr);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  physicalDevices.resize(count);
+  result = vkEnumeratePhysicalDevices(instance, &count, physicalDevices.data());
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  // any device type will do, software implementations included
+  std::vector<PhysicalDevice> devices;
+  for (auto physicalDevice : physicalDevices)
+  {
+    PhysicalDevice device = { physicalDevice };
+    vkGetPhysicalDeviceProperties(physicalDevice, &device.properties);
+    vkGetPhysicalDeviceFeatures(physicalDevice, &device.features);
+
+    uint32_t queueCount;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queues(queueCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueCount, queues.data());
+
+    device.hasAllQueues = false;
+    for (uint32_t index = 0; index < queueCount && !device.hasAllQueues; index++)
+    {
+      if (queues[index].queueFlags & VK_QUEUE_COMPUTE_BIT && queues[index].queueCount > 0)
+      {
+        // a single queue does everything, compute families always support transfer too
+        device.graphicsQueueIndex = index;
+        device.presentationQueueIndex = index;
+        device.computeQueueIndex = index;
+        device.transferQueueIndex = index;
+        device.hasAllQueues = true;
+      }
+    }
+
+    if (!device.hasAllQueues)
+    {
+      continue;
+    }
+
+    uint32_t extCount;
+    result = vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, nullptr);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    std::vector<VkExtensionProperties> extensions(extCount);
+    result = vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, extensions.data());
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    std::set<std::string> required(requiredExtensions.begin(), requiredExtensions.end());
+
+    for (auto extension : extensions)
+    {
+      for (auto required : requiredExtensions)
+      {
+        if (strcmp(required, extension.extensionName) == 0)
+        {
+          device.supportedExtensions.push_back(required);
+        }
+      }
+
+      required.erase(extension.extensionName);
+    }
+
+    device.hasAllRequiredExtensions = required.empty();
+    if (device.hasAllRequiredExtensions)
+    {
+      devices.push_back(device);
+    }
+  }
+
+  return devices;
+}
+
+VulkanCreation<ComputeContext> CreateComputeContext(const PhysicalDevice& physicalDevice)
+{
+  ComputeContext context;
+  context.physicalDevice = physicalDevice;
+
+  VkPhysicalDeviceFeatures features = {};
+
+  VkPhysicalDeviceVulkan12Features features12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+  features12.pNext = nullptr;
+  features12.timelineSemaphore = VK_TRUE;
+
+  auto deviceCreation = CreateLogicalDevice(physicalDevice, &features, &features12);
+  if (std::holds_alternative<VkResult>(deviceCreation))
+  {
+    return std::get<VkResult>(deviceCreation);
+  }
+  context.device = std::get<VkDevice>(deviceCreation);
+
+  vkGetDeviceQueue(context.device, physicalDevice.computeQueueIndex, 0, &context.queue);
+
+  auto commandPoolCreation = CreateCommandPool(context.device, physicalDevice.computeQueueIndex);
+  if (std::holds_alternative<VkResult>(commandPoolCreation))
+  {
+    vkDestroyDevice(context.device, nullptr);
+    return std::get<VkResult>(commandPoolCreation);
+  }
+  context.commandPool = std::get<VkCommandPool>(commandPoolCreation);
+
+  context.vkCmdPushDescriptorSetKHR = (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr(context.device, "vkCmdPushDescriptorSetKHR");
+  if (!context.vkCmdPushDescriptorSetKHR)
+  {
+    vkDestroyCommandPool(context.device, context.commandPool, nullptr);
+    vkDestroyDevice(context.device, nullptr);
+    return VK_ERROR_EXTENSION_NOT_PRESENT;
+  }
+
+  return context;
+}
+
+void DestroyComputeContext(const ComputeContext& context)
+{
+  vkDestroyCommandPool(context.device, context.commandPool, nullptr);
+  vkDestroyDevice(context.device, nullptr);
+}
+
+VulkanCreation<Swapchain> CreateSwapchain(PhysicalDevice physicalDevice, VkSurfaceKHR surface, VkDevice device, VkExtent2D defaultExtent, VkPresentModeKHR presentMode, VkSwapchainKHR oldSwapchain)
 {
   Swapchain swapchain;
   VkSurfaceFormatKHR surfaceFormat = physicalDevice.formats[0];
   VkPresentModeKHR bestMode = VK_PRESENT_MODE_FIFO_KHR;
   VkExtent2D extent = defaultExtent;
 
+  // the extent changes with the window, what was queried at device selection may be stale
+  auto result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &physicalDevice.capabilities);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
   if (physicalDevice.formats.size() == 1 && physicalDevice.formats[0].format == VK_FORMAT_UNDEFINED)
   {
     surfaceFormat = { VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
@@ -404,16 +572,10 @@ VulkanCreation<Swapchain> CreateSwapchain(PhysicalDevice physicalDevice, VkSurfa
     }
   }
 
-  for (const auto& availablePresentMode : physicalDevice.presentModes)
+  // FIFO is the only mode every surface has to support
+  if (std::find(physicalDevice.presentModes.begin(), physicalDevice.presentModes.end(), presentMode) != physicalDevice.presentModes.end())
   {
-    if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-    {
-      bestMode = availablePresentMode;
-    }
-    else if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
-    {
-      bestMode = availablePresentMode;
-    }
+    bestMode = presentMode;
   }
 
   if (physicalDevice.capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max())
@@ -447,7 +609,7 @@ VulkanCreation<Swapchain> CreateSwapchain(PhysicalDevice physicalDevice, VkSurfa
   createInfo.presentMode = bestMode;
   createInfo.clipped = VK_TRUE;
 
-  createInfo.oldSwapchain = VK_NULL_HANDLE;
+  createInfo.oldSwapchain = oldSwapchain;
 
   uint32_t queueFamilyIndices[] = { physicalDevice.graphicsQueueIndex, physicalDevice.presentationQueueIndex };
 
@@ -462,7 +624,7 @@ VulkanCreation<Swapchain> CreateSwapchain(PhysicalDevice physicalDevice, VkSurfa
     createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
   }
 
-  auto result = vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapchain.swapchain);
+  result = vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapchain.swapchain);
   if (result != VK_SUCCESS)
   {
     return result;
@@ -470,6 +632,7 @@ VulkanCreation<Swapchain> CreateSwapchain(PhysicalDevice physicalDevice, VkSurfa
 
   swapchain.format = surfaceFormat.format;
   swapchain.extent = extent;
+  swapchain.presentMode = bestMode;
 
   uint32_t swapchainImageCount;
   result = vkGetSwapchainImagesKHR(device, swapchain.swapchain, &swapchainImageCount, nullptr);
@@ -489,8 +652,16 @@ VulkanCreation<Swapchain> CreateSwapchain(PhysicalDevice physicalDevice, VkSurfa
   return swapchain;
 }
 
-VulkanCreation<Image2D> CreateImage2D(PhysicalDevice physicalDevice, VkDevice device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkImageLayout layout)
+std::vector<uint32_t> UniqueQueueFamilies(const std::vector<uint32_t>& queueFamilies)
+{
+  std::set<uint32_t> unique(queueFamilies.begin(), queueFamilies.end());
+  return { unique.begin(), unique.end() };
+}
+
+VulkanCreation<Image2D> CreateImage2D(PhysicalDevice physicalDevice, VkDevice device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkImageLayout layout, const std::vector<uint32_t>& queueFamilies)
 {
+  std::vector<uint32_t> families = UniqueQueueFamilies(queueFamilies);
+
   Image2D image = {};
   image.format = format;
   image.width = width;
@@ -511,9 +682,9 @@ VulkanCreation<Image2D> CreateImage2D(PhysicalDevice physicalDevice, VkDevice de
   imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
   imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
   imageCreateInfo.usage = usage;
-  imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-  imageCreateInfo.queueFamilyIndexCount = 0;
-  imageCreateInfo.pQueueFamilyIndices = nullptr;
+  imageCreateInfo.sharingMode = families.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+  imageCreateInfo.queueFamilyIndexCount = families.size() > 1 ? uint32_t(families.size()) : 0;
+  imageCreateInfo.pQueueFamilyIndices = families.size() > 1 ? families.data() : nullptr;
   imageCreateInfo.initialLayout = layout;
 
   auto result = vkCreateImage(device, &imageCreateInfo, nullptr, &image.image);
@@ -656,17 +827,18 @@ VulkanCreation<VkDescriptorSetLayout> CreateDescriptorSetLayout(VkDevice device,
   return layout;
 }
 
-VulkanCreation<Buffer> CreateBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize requiredSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+VulkanCreation<Buffer> CreateBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize requiredSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, const std::vector<uint32_t>& queueFamilies)
 {
   Buffer buffer = {};
+  std::vector<uint32_t> families = UniqueQueueFamilies(queueFamilies);
 
   VkBufferCreateInfo bufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
   bufferCreateInfo.flags = 0;
   bufferCreateInfo.pNext = nullptr;
-  bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  bufferCreateInfo.sharingMode = families.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
   bufferCreateInfo.size = requiredSize;
-  bufferCreateInfo.pQueueFamilyIndices = nullptr;
-  bufferCreateInfo.queueFamilyIndexCount = 0;
+  bufferCreateInfo.pQueueFamilyIndices = families.size() > 1 ? families.data() : nullptr;
+  bufferCreateInfo.queueFamilyIndexCount = families.size() > 1 ? uint32_t(families.size()) : 0;
   bufferCreateInfo.usage = usage;
 
   auto result = vkCreateBuffer(device, &bufferCreateInfo, nullptr, &buffer.buffer);
@@ -860,6 +1032,45 @@ VulkanCreation<VkPipeline> CreatePipeline(VkDevice device, VkPipelineLayout layo
   return pipeline;
 }
 
+VulkanCreation<VkPipeline> CreateComputePipeline(VkDevice device, VkPipelineLayout layout, const std::string& computeShaderFileName)
+{
+  auto computeShaderCode = ReadFile(computeShaderFileName);
+
+  auto computeShaderCreation = CreateShaderModule(device, computeShaderCode);
+  if (std::holds_alternative<VkResult>(computeShaderCreation))
+  {
+    return std::get<VkResult>(computeShaderCreation);
+  }
+  VkShaderModule computeShader = std::get<VkShaderModule>(computeShaderCreation);
+
+  VkPipelineShaderStageCreateInfo stageInfo = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+  stageInfo.flags = 0;
+  stageInfo.pNext = nullptr;
+  stageInfo.pName = "main";
+  stageInfo.module = computeShader;
+  stageInfo.pSpecializationInfo = nullptr;
+  stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+  VkComputePipelineCreateInfo pipelineInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+  pipelineInfo.flags = 0;
+  pipelineInfo.pNext = nullptr;
+  pipelineInfo.stage = stageInfo;
+  pipelineInfo.layout = layout;
+  pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+  pipelineInfo.basePipelineIndex = -1;
+
+  VkPipeline pipeline;
+  auto result = vkCreateComputePipelines(device, nullptr, 1, &pipelineInfo, nullptr, &pipeline);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  vkDestroyShaderModule(device, computeShader, nullptr);
+
+  return pipeline;
+}
+
 VkDescriptorSetLayoutBinding CreateDescriptorSetLayoutBinding(uint32_t binding, uint32_t count, VkDescriptorType type, VkShaderStageFlags stages)
 {
   VkDescriptorSetLayoutBinding setLayoutBinding = {};
@@ -1009,6 +1220,8 @@ VulkanCreation<VkRenderPass> CreateRenderPass(VkDevice device, const std::vector
 
 VulkanCreation<VkFramebuffer> CreateFramebuffer(VkDevice device, VkRenderPass renderPass, uint32_t width, uint32_t height, const std::vector<VkImageView>& attachments)
 {
+  PROFILE_SCOPE("CreateFramebuffer");
+
   VkFramebufferCreateInfo framebufferCreateInfo = { VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
   framebufferCreateInfo.flags = 0;
   framebufferCreateInfo.pNext = nullptr;
@@ -1069,6 +1282,8 @@ VkResult BeginCommandBuffer(VkCommandBuffer cmd, VkCommandBufferUsageFlags usage
 
 void BeginRenderPass(VkCommandBuffer cmd, VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent, const std::vector<VkClearValue>& clearValues)
 {
+  PROFILE_SCOPE("BeginRenderPass");
+
   VkRenderPassBeginInfo renderPassInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
   renderPassInfo.renderPass = renderPass;
   renderPassInfo.framebuffer = framebuffer;
@@ -1099,6 +1314,15 @@ void TransitionImageLayout(VkCommandBuffer cmd, VkImage image, VkImageLayout old
   vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 }
 
+void GlobalBarrier(VkCommandBuffer cmd, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage)
+{
+  VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+  barrier.srcAccessMask = srcAccess;
+  barrier.dstAccessMask = dstAccess;
+
+  vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
 VulkanCreation<VkFence> CreateFence(VkDevice device)
 {
   VkFenceCreateInfo fenceCreateInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
@@ -1115,6 +1339,108 @@ VulkanCreation<VkFence> CreateFence(VkDevice device)
   return fence;
 }
 
+VulkanCreation<VkSemaphore> CreateBinarySemaphore(VkDevice device)
+{
+  VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+  semaphoreInfo.pNext = nullptr;
+  semaphoreInfo.flags = 0;
+
+  VkSemaphore semaphore;
+  auto result = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  return semaphore;
+}
+
+VulkanCreation<VkSemaphore> CreateTimelineSemaphore(VkDevice device, uint64_t initialValue)
+{
+  VkSemaphoreTypeCreateInfo typeInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+  typeInfo.pNext = nullptr;
+  typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  typeInfo.initialValue = initialValue;
+
+  VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+  semaphoreInfo.pNext = &typeInfo;
+  semaphoreInfo.flags = 0;
+
+  VkSemaphore semaphore;
+  auto result = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  return semaphore;
+}
+
+VkResult WaitTimelineSemaphore(VkDevice device, VkSemaphore semaphore, uint64_t value, uint64_t timeout)
+{
+  VkSemaphoreWaitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+  waitInfo.pNext = nullptr;
+  waitInfo.flags = 0;
+  waitInfo.semaphoreCount = 1;
+  waitInfo.pSemaphores = &semaphore;
+  waitInfo.pValues = &value;
+
+  return vkWaitSemaphores(device, &waitInfo, timeout);
+}
+
+VkResult QueueSubmit(VkQueue queue, VkCommandBuffer cmd, const std::vector<SemaphoreSubmit>& waits, const std::vector<SemaphoreSubmit>& signals, VkFence fence)
+{
+  PROFILE_SCOPE("QueueSubmit");
+
+  std::vector<VkSemaphore> waitSemaphores, signalSemaphores;
+  std::vector<uint64_t> waitValues, signalValues;
+  std::vector<VkPipelineStageFlags> waitStages;
+
+  for (auto& wait : waits)
+  {
+    waitSemaphores.push_back(wait.semaphore);
+    waitValues.push_back(wait.value);
+    waitStages.push_back(wait.stage);
+  }
+
+  for (auto& signal : signals)
+  {
+    signalSemaphores.push_back(signal.semaphore);
+    signalValues.push_back(signal.value);
+  }
+
+  // binary semaphores in the same submit just ignore their value
+  VkTimelineSemaphoreSubmitInfo timelineInfo = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+  timelineInfo.pNext = nullptr;
+  timelineInfo.waitSemaphoreValueCount = uint32_t(waitValues.size());
+  timelineInfo.pWaitSemaphoreValues = waitValues.data();
+  timelineInfo.signalSemaphoreValueCount = uint32_t(signalValues.size());
+  timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+  VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+  submitInfo.pNext = &timelineInfo;
+  submitInfo.commandBufferCount = cmd != VK_NULL_HANDLE ? 1 : 0;
+  submitInfo.pCommandBuffers = &cmd;
+  submitInfo.waitSemaphoreCount = uint32_t(waitSemaphores.size());
+  submitInfo.pWaitSemaphores = waitSemaphores.data();
+  submitInfo.pWaitDstStageMask = waitStages.data();
+  submitInfo.signalSemaphoreCount = uint32_t(signalSemaphores.size());
+  submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+  std::lock_guard<std::mutex> lock(QueueMutex(queue));
+  return vkQueueSubmit(queue, 1, &submitInfo, fence);
+}
+
+std::mutex& QueueMutex(VkQueue queue)
+{
+  // families without a dedicated queue hand out the same VkQueue for several roles
+  static std::mutex registryMutex;
+  static std::map<VkQueue, std::mutex> mutexes;
+
+  std::lock_guard<std::mutex> lock(registryMutex);
+  return mutexes[queue];
+}
+
 void FreeBuffer(VkDevice device, const Buffer& buffer)
 {
   vkFreeMemory(device, buffer.memory, nullptr);
@@ -1128,7 +1454,7 @@ void FreeImage(VkDevice device, const Image2D& image)
   vkDestroyImage(device, image.image, nullptr);
 }
 
-VulkanCreation<VkSampler> CreateSampler(VkDevice device, VkFilter filter, VkSamplerAddressMode mode, float anisotropyLevel, VkBool32 unnormalizedCoords)
+VulkanCreation<VkSampler> CreateSampler(VkDevice device, VkFilter filter, VkSamplerAddressMode mode, float anisotropyLevel, VkBool32 unnormalizedCoords, VkBorderColor borderColor)
 {
   VkSamplerCreateInfo samplerInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
   samplerInfo.pNext = nullptr;
@@ -1145,7 +1471,7 @@ VulkanCreation<VkSampler> CreateSampler(VkDevice device, VkFilter filter, VkSamp
   samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
   samplerInfo.minLod = 0.0f;
   samplerInfo.maxLod = 0.0f;
-  samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;;
+  samplerInfo.borderColor = borderColor;
   samplerInfo.unnormalizedCoordinates = unnormalizedCoords;
 
   VkSampler sampler;
@@ -1156,4 +1482,109 @@ VulkanCreation<VkSampler> CreateSampler(VkDevice device, VkFilter filter, VkSamp
   }
 
   return sampler;
-}
\ No newline at end of file
+}
+
+VkResult ComputePass::Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, const std::string& computeShaderFileName)
+{
+  this->physicalDevice = physicalDevice.device;
+  this->device = device;
+  this->vkCmdPushDescriptorSetKHR = vkCmdPushDescriptorSetKHR;
+
+  auto commandPoolCreation = CreateCommandPool(device, physicalDevice.computeQueueIndex);
+  if (std::holds_alternative<VkResult>(commandPoolCreation))
+  {
+    return std::get<VkResult>(commandPoolCreation);
+  }
+  commandPool = std::get<VkCommandPool>(commandPoolCreation);
+
+  VkDescriptorSetLayoutBinding imageBinding = CreateDescriptorSetLayoutBinding(0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+  VkDescriptorSetLayoutBinding bufferBinding = CreateDescriptorSetLayoutBinding(1, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+  auto descriptorSetLayoutCreation = CreateDescriptorSetLayout(device, { imageBinding, bufferBinding });
+  if (std::holds_alternative<VkResult>(descriptorSetLayoutCreation))
+  {
+    return std::get<VkResult>(descriptorSetLayoutCreation);
+  }
+  descriptorSetLayout = std::get<VkDescriptorSetLayout>(descriptorSetLayoutCreation);
+
+  VkPushConstantRange pushConstant = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t) };
+  auto pipelineLayoutCreation = CreatePipelineLayout(device, { descriptorSetLayout }, { pushConstant });
+  if (std::holds_alternative<VkResult>(pipelineLayoutCreation))
+  {
+    return std::get<VkResult>(pipelineLayoutCreation);
+  }
+  pipelineLayout = std::get<VkPipelineLayout>(pipelineLayoutCreation);
+
+  auto pipelineCreation = CreateComputePipeline(device, pipelineLayout, computeShaderFileName);
+  if (std::holds_alternative<VkResult>(pipelineCreation))
+  {
+    return std::get<VkResult>(pipelineCreation);
+  }
+  pipeline = std::get<VkPipeline>(pipelineCreation);
+
+  return VK_SUCCESS;
+}
+
+void ComputePass::Destroy()
+{
+  vkDestroyPipeline(device, pipeline, nullptr);
+  vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+  vkDestroyCommandPool(device, commandPool, nullptr);
+}
+
+VkResult ComputePass::CreateMappedBuffer(VkDeviceSize size, Buffer* buffer, void** data) const
+{
+  auto bufferCreation = CreateBuffer(physicalDevice, device, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  if (std::holds_alternative<VkResult>(bufferCreation))
+  {
+    return std::get<VkResult>(bufferCreation);
+  }
+  *buffer = std::get<Buffer>(bufferCreation);
+
+  auto result = vkMapMemory(device, buffer->memory, 0, size, 0, data);
+  if (result != VK_SUCCESS)
+  {
+    FreeBuffer(device, *buffer);
+  }
+
+  return result;
+}
+
+void ComputePass::FreeMappedBuffer(const Buffer& buffer) const
+{
+  vkUnmapMemory(device, buffer.memory);
+  FreeBuffer(device, buffer);
+}
+
+VkResult ComputePass::AllocateSubmission(VkCommandBuffer* command, VkFence* fence) const
+{
+  auto result = AllocateCommandBuffer(device, commandPool, 1, command);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  auto fenceCreation = CreateFence(device);
+  if (std::holds_alternative<VkResult>(fenceCreation))
+  {
+    return std::get<VkResult>(fenceCreation);
+  }
+  *fence = std::get<VkFence>(fenceCreation);
+
+  return VK_SUCCESS;
+}
+
+void ComputePass::Bind(VkCommandBuffer command, const Image2D& image, VkBuffer buffer, uint32_t constant) const
+{
+  // the write descriptor sets only point into these
+  std::vector<VkDescriptorImageInfo> imageInfos = { { VK_NULL_HANDLE, image.view, VK_IMAGE_LAYOUT_GENERAL } };
+  std::vector<VkDescriptorBufferInfo> bufferInfos = { CreateDescriptorBufferInfo(buffer, 0, VK_WHOLE_SIZE) };
+
+  std::array<VkWriteDescriptorSet, 2> writeDescriptorSets = {};
+  writeDescriptorSets[0] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, {}, imageInfos);
+  writeDescriptorSets[1] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, bufferInfos, {});
+
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+  vkCmdPushDescriptorSetKHR(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, uint32_t(writeDescriptorSets.size()), writeDescriptorSets.data());
+  vkCmdPushConstants(command, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &constant);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+#include <string>
 #include <variant>
 #include <vector>
 
@@ -19,20 +21,26 @@ VulkanCreation<std::vector<const char*>> CheckInstanceExtensions(const std::vect
 VulkanCreation<VkInstance> CreateInstance(const char* applicationName, uint32_t applicationVersion, uint32_t apiVersion, const std::vector<const char*>& layers, const std::vector<const char*>& extensions);
 
 VulkanCreation<PhysicalDevice> GetSuitablePhysicalDevice(VkInstance instance, VkSurfaceKHR surface, const std::vector<const char*>& requiredExtensions);
-VulkanCreation<VkDevice> CreateLogicalDevice(PhysicalDevice physicalDevice, VkPhysicalDeviceFeatures *features);
-VulkanCreation<Swapchain> CreateSwapchain(PhysicalDevice physicalDevice, VkSurfaceKHR surface, VkDevice device, VkExtent2D defaultExtent);
-
-VulkanCreation<Image2D> CreateImage2D(PhysicalDevice physicalDevice, VkDevice device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkImageLayout layout);
+VulkanCreation<VkDevice> CreateLogicalDevice(PhysicalDevice physicalDevice, VkPhysicalDeviceFeatures *features, void* featureChain = nullptr);
+VulkanCreation<std::vector<PhysicalDevice>> GetComputePhysicalDevices(VkInstance instance, const std::vector<const char*>& requiredExtensions);
+VulkanCreation<ComputeContext> CreateComputeContext(const PhysicalDevice& physicalDevice);
+void DestroyComputeContext(const ComputeContext& context);
+// the present mode falls back to FIFO when the surface doesn't offer it, the old swapchain is retired but not destroyed
+VulkanCreation<Swapchain> CreateSwapchain(PhysicalDevice physicalDevice, VkSurfaceKHR surface, VkDevice device, VkExtent2D defaultExtent, VkPresentModeKHR presentMode, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+
+std::vector<uint32_t> UniqueQueueFamilies(const std::vector<uint32_t>& queueFamilies);
+VulkanCreation<Image2D> CreateImage2D(PhysicalDevice physicalDevice, VkDevice device, VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkImageLayout layout, const std::vector<uint32_t>& queueFamilies = {});
 VulkanCreation<VkImageView> CreateImageView2D(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectMast = VK_IMAGE_ASPECT_COLOR_BIT, uint32_t baseMipLevel = 0, uint32_t levelCount = 1, uint32_t baseArrayLayer = 0, uint32_t layerCount = 1);
 
 std::vector<char> ReadFile(const std::string& fileName);
 VulkanCreation<VkShaderModule> CreateShaderModule(VkDevice device, const std::vector<char>& code);
 VulkanCreation<VkPipelineLayout> CreatePipelineLayout(VkDevice device, const std::vector<VkDescriptorSetLayout>& layouts, const std::vector<VkPushConstantRange>& pushConstants);
 VulkanCreation<VkPipeline> CreatePipeline(VkDevice device, VkPipelineLayout layout, VkExtent2D extent, VkRenderPass renderPass, const std::string& vertexShaderFileName, const std::string& fragmentShaderFileName);
+VulkanCreation<VkPipeline> CreateComputePipeline(VkDevice device, VkPipelineLayout layout, const std::string& computeShaderFileName);
 
 VulkanCreation<VkDescriptorSetLayout> CreateDescriptorSetLayout(VkDevice device, const std::vector<VkDescriptorSetLayoutBinding>& bindings);
 
-VulkanCreation<Buffer> CreateBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize requiredSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+VulkanCreation<Buffer> CreateBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize requiredSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, const std::vector<uint32_t>& queueFamilies = {});
 uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
 VkDescriptorSetLayoutBinding CreateDescriptorSetLayoutBinding(uint32_t binding, uint32_t count, VkDescriptorType type, VkShaderStageFlags stages);
@@ -54,10 +62,44 @@ VkResult AllocateCommandBuffer(VkDevice device, VkCommandPool pool, uint32_t cou
 VkResult BeginCommandBuffer(VkCommandBuffer cmd, VkCommandBufferUsageFlags usage);
 void BeginRenderPass(VkCommandBuffer cmd, VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent, const std::vector<VkClearValue>& clearValues);
 void TransitionImageLayout(VkCommandBuffer cmd, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
+// a memory barrier over everything, for engines that hand buffers and images between copies and dispatches
+void GlobalBarrier(VkCommandBuffer cmd, VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
 
 VulkanCreation<VkFence> CreateFence(VkDevice device);
+VulkanCreation<VkSemaphore> CreateBinarySemaphore(VkDevice device);
+VulkanCreation<VkSemaphore> CreateTimelineSemaphore(VkDevice device, uint64_t initialValue);
+VkResult WaitTimelineSemaphore(VkDevice device, VkSemaphore semaphore, uint64_t value, uint64_t timeout);
+VkResult QueueSubmit(VkQueue queue, VkCommandBuffer cmd, const std::vector<SemaphoreSubmit>& waits, const std::vector<SemaphoreSubmit>& signals, VkFence fence = VK_NULL_HANDLE);
+
+// a queue may be used from several threads, everything but QueueSubmit has to lock this itself
+std::mutex& QueueMutex(VkQueue queue);
 
 void FreeBuffer(VkDevice device, const Buffer& buffer);
 void FreeImage(VkDevice device, const Image2D& image);
 
-VulkanCreation<VkSampler> CreateSampler(VkDevice device, VkFilter filter, VkSamplerAddressMode mode, float anisotropyLevel, VkBool32 unnormalizedCoords);
\ No newline at end of file
+VulkanCreation<VkSampler> CreateSampler(VkDevice device, VkFilter filter, VkSamplerAddressMode mode, float anisotropyLevel, VkBool32 unnormalizedCoords, VkBorderColor borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK);
+
+// A compute shader over a storage image at binding 0 and a storage buffer at binding 1 with a single uint32_t push constant,
+// the shape of every pass moving boards between host buffers and board images, with a pool for the command buffers recording it.
+struct ComputePass
+{
+  VkPhysicalDevice physicalDevice;
+  VkDevice device;
+  VkCommandPool commandPool;
+  VkDescriptorSetLayout descriptorSetLayout;
+  VkPipelineLayout pipelineLayout;
+  VkPipeline pipeline;
+  PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR;
+
+  VkResult Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, const std::string& computeShaderFileName);
+  void Destroy();
+
+  // a host visible storage buffer that stays mapped until it is freed again
+  VkResult CreateMappedBuffer(VkDeviceSize size, Buffer* buffer, void** data) const;
+  void FreeMappedBuffer(const Buffer& buffer) const;
+
+  // a command buffer from the pool and an unsignaled fence, for one submission in flight at a time
+  VkResult AllocateSubmission(VkCommandBuffer* command, VkFence* fence) const;
+
+  void Bind(VkCommandBuffer command, const Image2D& image, VkBuffer buffer, uint32_t constant) const;
+};
@@ -0,0 +1,241 @@
+#include "GenerationsEngine.h"
+#include "Profile.h"
+
+#include <algorithm>
+
+// the cells whose count planes hold at least k, compared from the lowest bit up
+static inline uint64_t AtLeast(const uint64_t* s, uint32_t k)
+{
+  uint64_t atLeast = ~uint64_t(0);
+  for (uint32_t i = 0; i < 4; i++)
+  {
+    // without branches, so the loop over the words still gets vectorized
+    uint64_t bit = uint64_t(0) - ((k >> i) & 1);
+    atLeast = (s[i] & atLeast) | (~bit & (s[i] | atLeast));
+  }
+
+  return atLeast;
+}
+
+// a row of words, up, row and down point at the halo word in front of it; the planes as template parameter
+// let the compiler keep a word's state in registers and vectorize the loop
+template<uint32_t PLANES>
+static void StepRow(const uint64_t* up, const uint64_t* row, const uint64_t* down, const uint64_t* q, uint64_t* out, uint32_t words, uint64_t lastWordMask, const Rule& rule, const uint32_t* bounds)
+{
+  uint64_t middle = rule.middle ? ~uint64_t(0) : 0;
+  uint32_t states = rule.states;
+
+  for (uint32_t x = 1; x <= words; x++)
+  {
+    uint64_t neighbours[9] =
+    {
+      (up[x] << 1) | (up[x - 1] >> 63), up[x], (up[x] >> 1) | (up[x + 1] << 63),
+      (row[x] << 1) | (row[x - 1] >> 63), (row[x] >> 1) | (row[x + 1] << 63),
+      (down[x] << 1) | (down[x - 1] >> 63), down[x], (down[x] >> 1) | (down[x + 1] << 63),
+      row[x] & middle
+    };
+
+    // the full count in four planes, the rule may ask for any of them
+    uint64_t s[4] = { 0, 0, 0, 0 };
+    for (uint64_t n : neighbours)
+    {
+      uint64_t c0 = s[0] & n;
+      s[0] ^= n;
+      uint64_t c1 = s[1] & c0;
+      s[1] ^= c0;
+      uint64_t c2 = s[2] & c1;
+      s[2] ^= c1;
+      s[3] |= c2;
+    }
+
+    const uint64_t* current = q + size_t(x - 1) * PLANES;
+
+    uint64_t dead = 0;
+    for (uint32_t p = 0; p < PLANES; p++)
+    {
+      dead |= current[p];
+    }
+    dead = ~dead;
+
+    // every other cell counts up by one and is back at 0 when it reaches the count of states
+    uint64_t next[PLANES];
+    uint64_t carry = ~uint64_t(0);
+    uint64_t wrapped = ~uint64_t(0);
+    for (uint32_t p = 0; p < PLANES; p++)
+    {
+      next[p] = current[p] ^ carry;
+      carry &= current[p];
+      wrapped &= (states >> p) & 1 ? next[p] : ~next[p];
+    }
+
+    uint64_t born = AtLeast(s, bounds[0]) & ~AtLeast(s, bounds[1]);
+    uint64_t survives = row[x] & AtLeast(s, bounds[2]) & ~AtLeast(s, bounds[3]);
+    uint64_t counting = ~dead & ~survives & ~wrapped;
+    uint64_t one = (dead & born) | survives;
+
+    uint64_t mask = x == words ? lastWordMask : ~uint64_t(0);
+    for (uint32_t p = 0; p < PLANES; p++)
+    {
+      out[size_t(x - 1) * PLANES + p] = ((next[p] & counting) | (p == 0 ? one : 0)) & mask;
+    }
+  }
+}
+
+GenerationsEngine::GenerationsEngine(uint32_t width, uint32_t height, Topology topology, const Rule& rule) : width(width), height(height), topology(topology), rule(rule)
+{
+  wordsPerRow = (width + 63) / 64;
+  stride = wordsPerRow + 2;
+  lastWordMask = width % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (width % 64)) - 1;
+
+  planeCount = 1;
+  while ((uint64_t(1) << planeCount) < rule.states)
+  {
+    planeCount++;
+  }
+
+  // a cell with the middle counts itself, so no count reaches 10 and the bounds fit into the four count planes
+  bounds = { std::min(rule.birthMin, 10u), std::min(rule.birthMax, 9u) + 1, std::min(rule.survivalMin, 10u), std::min(rule.survivalMax, 9u) + 1 };
+
+  planes.resize(size_t(height) * wordsPerRow * planeCount);
+  nextPlanes.resize(planes.size());
+  alive.resize(size_t(stride) * (height + 2));
+}
+
+void GenerationsEngine::SetBoard(const PackedBoard& board)
+{
+  std::fill(planes.begin(), planes.end(), 0);
+
+  for (uint32_t y = 0; y < height && y < board.height; y++)
+  {
+    for (uint32_t x = 0; x < wordsPerRow && x < board.wordsPerRow; x++)
+    {
+      uint64_t word = board.words[size_t(y) * board.wordsPerRow + x];
+      planes[PlaneIndex(x, y)] = x + 1 == wordsPerRow ? word & lastWordMask : word;
+    }
+  }
+}
+
+PackedBoard GenerationsEngine::GetBoard() const
+{
+  PackedBoard board = CreatePackedBoard(width, height);
+
+  for (uint32_t y = 0; y < height; y++)
+  {
+    for (uint32_t x = 0; x < wordsPerRow; x++)
+    {
+      const uint64_t* q = &planes[PlaneIndex(x, y)];
+
+      uint64_t word = q[0];
+      for (uint32_t p = 1; p < planeCount; p++)
+      {
+        word &= ~q[p];
+      }
+      board.words[size_t(y) * wordsPerRow + x] = word;
+    }
+  }
+
+  return board;
+}
+
+void GenerationsEngine::SetCell(uint32_t x, uint32_t y, bool alive)
+{
+  if (x >= width || y >= height)
+  {
+    return;
+  }
+
+  uint64_t* q = &planes[PlaneIndex(x / 64, y)];
+  uint64_t bit = uint64_t(1) << (x % 64);
+  for (uint32_t p = 0; p < planeCount; p++)
+  {
+    q[p] &= ~bit;
+  }
+  q[0] |= alive ? bit : 0;
+}
+
+void GenerationsEngine::FillAlive()
+{
+  for (uint32_t y = 0; y < height; y++)
+  {
+    uint64_t* row = &alive[size_t(y + 1) * stride + 1];
+    for (uint32_t x = 0; x < wordsPerRow; x++)
+    {
+      const uint64_t* q = &planes[PlaneIndex(x, y)];
+
+      uint64_t word = q[0];
+      for (uint32_t p = 1; p < planeCount; p++)
+      {
+        word &= ~q[p];
+      }
+      row[x] = word;
+    }
+  }
+
+  // the halo the same way as CpuEngine's, rows first and then the column halo of every row including them
+  uint64_t* top = &alive[1];
+  uint64_t* bottom = &alive[size_t(height + 1) * stride + 1];
+  if (topology == Topology::Torus)
+  {
+    std::copy(&alive[size_t(height) * stride + 1], &alive[size_t(height) * stride + 1] + wordsPerRow, top);
+    std::copy(&alive[size_t(stride) + 1], &alive[size_t(stride) + 1] + wordsPerRow, bottom);
+  }
+  else
+  {
+    std::fill(top, top + wordsPerRow, 0);
+    std::fill(bottom, bottom + wordsPerRow, 0);
+  }
+
+  uint32_t tail = width % 64;
+  for (uint32_t y = 0; y <= height + 1; y++)
+  {
+    uint64_t* row = &alive[size_t(y) * stride];
+    row[0] = 0;
+    row[wordsPerRow + 1] = 0;
+
+    if (topology == Topology::Torus)
+    {
+      uint64_t first = row[1] & 1;
+      uint64_t last = (row[wordsPerRow] >> ((width - 1) % 64)) & 1;
+
+      row[0] = last << 63;
+      if (tail != 0)
+      {
+        row[wordsPerRow] |= first << tail;
+      }
+      else
+      {
+        row[wordsPerRow + 1] = first;
+      }
+    }
+  }
+}
+
+void GenerationsEngine::Step()
+{
+  PROFILE_SCOPE("generations step");
+
+  FillAlive();
+
+  for (uint32_t y = 0; y < height; y++)
+  {
+    const uint64_t* up = &alive[size_t(y) * stride];
+    const uint64_t* row = &alive[size_t(y + 1) * stride];
+    const uint64_t* down = &alive[size_t(y + 2) * stride];
+    const uint64_t* q = &planes[PlaneIndex(0, y)];
+    uint64_t* out = &nextPlanes[PlaneIndex(0, y)];
+
+    switch (planeCount)
+    {
+    case 1: StepRow<1>(up, row, down, q, out, wordsPerRow, lastWordMask, rule, bounds.data()); break;
+    case 2: StepRow<2>(up, row, down, q, out, wordsPerRow, lastWordMask, rule, bounds.data()); break;
+    case 3: StepRow<3>(up, row, down, q, out, wordsPerRow, lastWordMask, rule, bounds.data()); break;
+    case 4: StepRow<4>(up, row, down, q, out, wordsPerRow, lastWordMask, rule, bounds.data()); break;
+    case 5: StepRow<5>(up, row, down, q, out, wordsPerRow, lastWordMask, rule, bounds.data()); break;
+    case 6: StepRow<6>(up, row, down, q, out, wordsPerRow, lastWordMask, rule, bounds.data()); break;
+    case 7: StepRow<7>(up, row, down, q, out, wordsPerRow, lastWordMask, rule, bounds.data()); break;
+    default: StepRow<8>(up, row, down, q, out, wordsPerRow, lastWordMask, rule, bounds.data()); break;
+    }
+  }
+
+  planes.swap(nextPlanes);
+}
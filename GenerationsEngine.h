@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Structs.h"
+#include "Board.h"
+
+// Generations rules of radius 1 on the host (Brian's Brain, Star Wars, B3/S23 as the case of two states),
+// 64 cells per word like CpuEngine. The state of a cell is a number kept in ceil(log2(states)) bit planes,
+// the planes of a word stored next to each other. A step is bit sliced throughout: the neighbours are summed
+// into four count planes, compared against the bounds of birth and survival, and the decaying cells count up with a
+// ripple carry across the planes, so a rule with a few states costs little more than a binary one.
+class GenerationsEngine
+{
+private:
+  uint32_t width;
+  uint32_t height;
+  uint32_t wordsPerRow;
+  uint32_t stride;
+  uint64_t lastWordMask;
+  Topology topology;
+  Rule rule;
+
+  uint32_t planeCount;
+  // the lowest count and one past the highest for birth, then for survival
+  std::array<uint32_t, 4> bounds;
+
+  // plane p of word x in row y at ((y * wordsPerRow) + x) * planeCount + p
+  std::vector<uint64_t> planes;
+  std::vector<uint64_t> nextPlanes;
+
+  // the cells in state 1, with a halo word on both sides of a row and a halo row above and below like CpuEngine
+  std::vector<uint64_t> alive;
+
+  size_t PlaneIndex(uint32_t x, uint32_t y) const { return (size_t(y) * wordsPerRow + x) * planeCount; }
+  void FillAlive();
+
+public:
+  GenerationsEngine(uint32_t width, uint32_t height, Topology topology, const Rule& rule);
+
+  // the live cells in state 1, every other cell in state 0
+  void SetBoard(const PackedBoard& board);
+
+  // the cells in state 1, the decaying ones are dead
+  PackedBoard GetBoard() const;
+
+  // cells outside the board are ignored
+  void SetCell(uint32_t x, uint32_t y, bool alive);
+
+  void Step();
+};
@@ -0,0 +1,247 @@
+#include "History.h"
+
+#include <algorithm>
+
+constexpr size_t MAX_PENDING_CAPTURES = 8;
+
+static void WriteVarint(uint64_t value, std::vector<uint8_t>* out)
+{
+  while (value >= 0x80)
+  {
+    out->push_back(uint8_t(value | 0x80));
+    value >>= 7;
+  }
+
+  out->push_back(uint8_t(value));
+}
+
+static uint64_t ReadVarint(const uint8_t** in)
+{
+  uint64_t value = 0;
+  uint32_t shift = 0;
+
+  while (**in & 0x80)
+  {
+    value |= uint64_t(**in & 0x7F) << shift;
+    shift += 7;
+    (*in)++;
+  }
+
+  value |= uint64_t(**in) << shift;
+  (*in)++;
+
+  return value;
+}
+
+// a sequence of [zero word count, literal word count, literal words]
+static void EncodeWords(const std::vector<uint64_t>& words, std::vector<uint8_t>* out)
+{
+  size_t i = 0;
+  while (i < words.size())
+  {
+    size_t zeros = 0;
+    while (i + zeros < words.size() && words[i + zeros] == 0)
+    {
+      zeros++;
+    }
+
+    size_t literals = 0;
+    while (i + zeros + literals < words.size() && words[i + zeros + literals] != 0)
+    {
+      literals++;
+    }
+
+    WriteVarint(zeros, out);
+    WriteVarint(literals, out);
+
+    auto first = reinterpret_cast<const uint8_t*>(words.data() + i + zeros);
+    out->insert(out->end(), first, first + literals * sizeof(uint64_t));
+
+    i += zeros + literals;
+  }
+}
+
+// XORs the encoded words into the board, so the same decoder applies keyframes (onto an empty board) and deltas
+static void DecodeWords(const std::vector<uint8_t>& data, std::vector<uint64_t>* words)
+{
+  const uint8_t* in = data.data();
+  const uint8_t* end = data.data() + data.size();
+  size_t i = 0;
+
+  while (in < end)
+  {
+    i += size_t(ReadVarint(&in));
+    size_t literals = size_t(ReadVarint(&in));
+
+    for (size_t l = 0; l < literals; l++, i++)
+    {
+      uint64_t word;
+      std::copy(in, in + sizeof(uint64_t), reinterpret_cast<uint8_t*>(&word));
+      (*words)[i] ^= word;
+      in += sizeof(uint64_t);
+    }
+  }
+}
+
+GenerationHistory::GenerationHistory(size_t budget, uint32_t keyframeInterval)
+  : budget(budget), keyframeInterval(std::max(keyframeInterval, 1u)), bytes(0), width(0), height(0), previous(), sinceKeyframe(0),
+  pending("history", false, [this](std::pair<uint64_t, PackedBoard>&& capture)
+  {
+    std::lock_guard<std::mutex> lock(entriesMutex);
+    Store(capture.first, capture.second);
+  })
+{
+}
+
+void GenerationHistory::Capture(uint64_t generation, PackedBoard&& board)
+{
+  pending.TryPush({ generation, std::move(board) }, MAX_PENDING_CAPTURES);
+}
+
+void GenerationHistory::Clear()
+{
+  pending.Clear();
+
+  std::lock_guard<std::mutex> lock(entriesMutex);
+  entries.clear();
+  bytes = 0;
+  previous = {};
+  sinceKeyframe = 0;
+}
+
+void GenerationHistory::Store(uint64_t generation, const PackedBoard& board)
+{
+  // the simulation was rewound, everything from here on is a new branch
+  while (!entries.empty() && entries.back().generation >= generation)
+  {
+    bytes -= entries.back().data.size();
+    entries.pop_back();
+    previous = {};
+  }
+
+  Entry entry = {};
+  entry.generation = generation;
+  entry.keyframe = entries.empty() || sinceKeyframe >= keyframeInterval ||
+    previous.width != board.width || previous.height != board.height;
+
+  width = board.width;
+  height = board.height;
+
+  if (entry.keyframe)
+  {
+    EncodeWords(board.words, &entry.data);
+    sinceKeyframe = 0;
+  }
+  else
+  {
+    EncodeWords(DiffBoards(previous, board).words, &entry.data);
+  }
+
+  sinceKeyframe++;
+  bytes += entry.data.size();
+  entries.push_back(std::move(entry));
+  previous = board;
+
+  Evict();
+}
+
+void GenerationHistory::Evict()
+{
+  // deltas are useless without their keyframe, so the oldest keyframe goes together with its deltas
+  while (bytes > budget)
+  {
+    auto next = std::find_if(entries.begin() + 1, entries.end(), [](const Entry& e) { return e.keyframe; });
+    if (next == entries.end())
+    {
+      break;
+    }
+
+    size_t count = size_t(next - entries.begin());
+    for (size_t i = 0; i < count; i++)
+    {
+      bytes -= entries.front().data.size();
+      entries.pop_front();
+    }
+  }
+}
+
+void GenerationHistory::ReconstructEntry(size_t index, PackedBoard* board)
+{
+  size_t keyframe = index;
+  while (!entries[keyframe].keyframe)
+  {
+    keyframe--;
+  }
+
+  *board = CreatePackedBoard(width, height);
+  for (size_t i = keyframe; i <= index; i++)
+  {
+    DecodeWords(entries[i].data, &board->words);
+  }
+}
+
+bool GenerationHistory::Reconstruct(uint64_t generation, PackedBoard* board)
+{
+  std::lock_guard<std::mutex> lock(entriesMutex);
+
+  auto entry = std::find_if(entries.begin(), entries.end(), [generation](const Entry& e) { return e.generation == generation; });
+  if (entry == entries.end())
+  {
+    return false;
+  }
+
+  ReconstructEntry(size_t(entry - entries.begin()), board);
+  return true;
+}
+
+bool GenerationHistory::Previous(uint64_t generation, uint64_t* previousGeneration)
+{
+  std::lock_guard<std::mutex> lock(entriesMutex);
+
+  auto entry = std::find_if(entries.rbegin(), entries.rend(), [generation](const Entry& e) { return e.generation < generation; });
+  if (entry == entries.rend())
+  {
+    return false;
+  }
+
+  *previousGeneration = entry->generation;
+  return true;
+}
+
+bool GenerationHistory::Next(uint64_t generation, uint64_t* nextGeneration)
+{
+  std::lock_guard<std::mutex> lock(entriesMutex);
+
+  auto entry = std::find_if(entries.begin(), entries.end(), [generation](const Entry& e) { return e.generation > generation; });
+  if (entry == entries.end())
+  {
+    return false;
+  }
+
+  *nextGeneration = entry->generation;
+  return true;
+}
+
+size_t GenerationHistory::Bytes()
+{
+  std::lock_guard<std::mutex> lock(entriesMutex);
+  return bytes;
+}
+
+size_t GenerationHistory::Count()
+{
+  std::lock_guard<std::mutex> lock(entriesMutex);
+  return entries.size();
+}
+
+PackedBoard DiffBoards(const PackedBoard& a, const PackedBoard& b)
+{
+  PackedBoard diff = CreatePackedBoard(b.width, b.height);
+
+  for (size_t i = 0; i < diff.words.size() && i < a.words.size(); i++)
+  {
+    diff.words[i] = a.words[i] ^ b.words[i];
+  }
+
+  return diff;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Board.h"
+#include "BackgroundQueue.h"
+
+// Keeps the most recent generations within a memory budget.
+// Every keyframeInterval captures a full board is stored, the ones in between only store
+// the XOR against the previous capture. Both are run length encoded over zero words,
+// so a delta costs about as much as the number of words that changed.
+class GenerationHistory
+{
+private:
+  struct Entry
+  {
+    uint64_t generation;
+    bool keyframe;
+    std::vector<uint8_t> data;
+  };
+
+  size_t budget;
+  uint32_t keyframeInterval;
+
+  // owned by the worker, guarded by entriesMutex
+  std::deque<Entry> entries;
+  size_t bytes;
+  uint32_t width;
+  uint32_t height;
+  PackedBoard previous;
+  uint32_t sinceKeyframe;
+  std::mutex entriesMutex;
+
+  // handed over by Capture, last so the worker is done before anything above goes away
+  BackgroundQueue<std::pair<uint64_t, PackedBoard>> pending;
+
+  void Store(uint64_t generation, const PackedBoard& board);
+  void Evict();
+  void ReconstructEntry(size_t index, PackedBoard* board);
+
+public:
+  GenerationHistory(size_t budget, uint32_t keyframeInterval);
+  // drops the captures still pending
+  ~GenerationHistory() = default;
+
+  GenerationHistory(const GenerationHistory& history) = delete;
+  GenerationHistory& operator=(const GenerationHistory& history) = delete;
+
+  // never blocks on encoding, captures that pile up faster than they are encoded get dropped
+  void Capture(uint64_t generation, PackedBoard&& board);
+  void Clear();
+
+  bool Reconstruct(uint64_t generation, PackedBoard* board);
+  bool Previous(uint64_t generation, uint64_t* previous);
+  bool Next(uint64_t generation, uint64_t* next);
+
+  size_t Bytes();
+  size_t Count();
+};
+
+PackedBoard DiffBoards(const PackedBoard& a, const PackedBoard& b);
@@ -0,0 +1,153 @@
+#include "LaneEngine.h"
+#include "Profile.h"
+#include "Threads.h"
+
+#include <algorithm>
+
+// words [0, words) of a row, the cells to the left and right are lanes words away;
+// every word is independent of the others, so the loop gets vectorized as it is
+static void StepLanes(const uint64_t* up, const uint64_t* row, const uint64_t* down, uint64_t* out, size_t lanes, size_t words)
+{
+  for (size_t i = 0; i < words; i++)
+  {
+    uint64_t neighbours[8] =
+    {
+      up[i - lanes], up[i], up[i + lanes],
+      row[i - lanes], row[i + lanes],
+      down[i - lanes], down[i], down[i + lanes]
+    };
+
+    // the same adder as the cpu engine, s2 saturates at 4 or more
+    uint64_t s0 = 0, s1 = 0, s2 = 0;
+    for (uint64_t n : neighbours)
+    {
+      uint64_t c0 = s0 & n;
+      s0 ^= n;
+      uint64_t c1 = s1 & c0;
+      s1 ^= c0;
+      s2 |= c1;
+    }
+
+    out[i] = ~s2 & s1 & (s0 | row[i]);
+  }
+}
+
+LaneEngine::LaneEngine(uint32_t width, uint32_t height, uint32_t count, Topology topology) : width(width), height(height), count(count), topology(topology)
+{
+  lanes = (count + LANES_PER_WORD - 1) / LANES_PER_WORD;
+  stride = size_t(width + 2) * lanes;
+
+  // the plane's halo is never written, so it stays dead in both
+  cells.resize(stride * (height + 2));
+  previous.resize(cells.size());
+}
+
+void LaneEngine::SetBoard(uint32_t index, const PackedBoard& board)
+{
+  if (index >= count)
+  {
+    return;
+  }
+
+  size_t word = index / LANES_PER_WORD;
+  uint64_t bit = uint64_t(1) << (index % LANES_PER_WORD);
+
+  for (uint32_t y = 0; y < height; y++)
+  {
+    for (uint32_t x = 0; x < width; x++)
+    {
+      uint64_t& cell = cells[CellIndex(x, y) + word];
+      cell = x < board.width && y < board.height && GetCell(board, x, y) ? cell | bit : cell & ~bit;
+    }
+  }
+}
+
+PackedBoard LaneEngine::GetBoard(uint32_t index) const
+{
+  PackedBoard board = CreatePackedBoard(width, height);
+  if (index >= count)
+  {
+    return board;
+  }
+
+  size_t word = index / LANES_PER_WORD;
+  uint32_t shift = index % LANES_PER_WORD;
+
+  for (uint32_t y = 0; y < height; y++)
+  {
+    for (uint32_t x = 0; x < width; x++)
+    {
+      board.words[size_t(y) * board.wordsPerRow + x / 64] |= ((cells[CellIndex(x, y) + word] >> shift) & 1) << (x % 64);
+    }
+  }
+
+  return board;
+}
+
+void LaneEngine::CopyHalo()
+{
+  if (topology != Topology::Torus)
+  {
+    return;
+  }
+
+  // columns first, the rows copied after them bring the corners along
+  for (uint32_t y = 0; y < height; y++)
+  {
+    std::copy_n(&cells[CellIndex(width - 1, y)], lanes, &cells[CellIndex(0, y) - lanes]);
+    std::copy_n(&cells[CellIndex(0, y)], lanes, &cells[CellIndex(width, y)]);
+  }
+
+  std::copy_n(&cells[size_t(height) * stride], stride, &cells[0]);
+  std::copy_n(&cells[stride], stride, &cells[size_t(height + 1) * stride]);
+}
+
+void LaneEngine::Step()
+{
+  PROFILE_SCOPE("lane step");
+
+  CopyHalo();
+
+  // small batches are done before a thread would have started
+  size_t words = size_t(width) * lanes;
+  uint32_t threadCount = ThreadCount(uint32_t(std::min<size_t>(height, words * height / MIN_WORDS_PER_THREAD)));
+
+  auto stepRows = [&](uint32_t thread)
+  {
+    for (uint32_t y = thread; y < height; y += threadCount)
+    {
+      size_t first = CellIndex(0, y);
+      StepLanes(&cells[first - stride], &cells[first], &cells[first + stride], &previous[first], lanes, words);
+    }
+  };
+
+  ForEachThread(threadCount, stepRows);
+
+  cells.swap(previous);
+}
+
+std::vector<BatchStats> LaneEngine::Stats() const
+{
+  std::vector<BatchStats> stats(count, { 0, 0 });
+
+  // only the set bits are visited, settled soups are mostly dead
+  for (uint32_t y = 0; y < height; y++)
+  {
+    for (size_t i = CellIndex(0, y); i < CellIndex(width, y); i++)
+    {
+      uint32_t firstBoard = uint32_t(i % lanes) * LANES_PER_WORD;
+
+      for (uint64_t alive = cells[i]; alive != 0; alive &= alive - 1)
+      {
+        stats[firstBoard + LowestSetBit(alive)].population++;
+      }
+
+      for (uint64_t changed = cells[i] ^ previous[i]; changed != 0; changed &= changed - 1)
+      {
+        stats[firstBoard + LowestSetBit(changed)].changed++;
+      }
+    }
+  }
+
+  return stats;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Structs.h"
+#include "Board.h"
+
+// Many small boards of the same size on the host, transposed into bit lanes: bit b of a cell's word
+// is that cell on board b, so the B3/S23 adder runs once for 64 boards. More boards give every cell
+// several consecutive words, and since a cell's neighbours are always the same distance away in memory
+// the step is one flat loop that the compiler widens to the host's vector registers.
+// Like the CpuEngine the board carries a halo of one cell all around, refilled every step.
+class LaneEngine
+{
+public:
+  static constexpr uint32_t LANES_PER_WORD = 64;
+
+private:
+  static constexpr size_t MIN_WORDS_PER_THREAD = size_t(1) << 16;
+
+  uint32_t width;
+  uint32_t height;
+  uint32_t count;
+  // words per cell
+  uint32_t lanes;
+  size_t stride;
+  Topology topology;
+
+  std::vector<uint64_t> cells;
+  // the generation before the last step, once stepped
+  std::vector<uint64_t> previous;
+
+  size_t CellIndex(uint32_t x, uint32_t y) const { return size_t(y + 1) * stride + size_t(x + 1) * lanes; }
+  void CopyHalo();
+
+public:
+  LaneEngine(uint32_t width, uint32_t height, uint32_t count, Topology topology);
+
+  uint32_t Count() const { return count; }
+
+  void SetBoard(uint32_t index, const PackedBoard& board);
+  PackedBoard GetBoard(uint32_t index) const;
+
+  // rows are spread over all cores
+  void Step();
+
+  // population of every board, and the cells changed by the last step
+  std::vector<BatchStats> Stats() const;
+};
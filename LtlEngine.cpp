@@ -0,0 +1,166 @@
+#include "LtlEngine.h"
+#include "Profile.h"
+#include "Threads.h"
+
+#include <algorithm>
+
+// rows y with y % threadCount == thread, on the calling thread and the others
+template<typename F>
+static void ForEachRow(uint32_t rows, F work)
+{
+  uint32_t threadCount = ThreadCount(rows);
+
+  ForEachThread(threadCount, [&](uint32_t thread)
+  {
+    for (uint32_t y = thread; y < rows; y += threadCount)
+    {
+      work(y);
+    }
+  });
+}
+
+LtlEngine::LtlEngine(uint32_t width, uint32_t height, Topology topology, const Rule& rule) : width(width), height(height), topology(topology), rule(rule)
+{
+  paddedWidth = width + 2 * rule.radius;
+  paddedHeight = height + 2 * rule.radius;
+
+  cells.resize(size_t(paddedWidth) * paddedHeight);
+  next.resize(cells.size());
+  table.resize(size_t(paddedWidth + 1) * (paddedHeight + 1));
+}
+
+void LtlEngine::SetBoard(const PackedBoard& board)
+{
+  std::fill(cells.begin(), cells.end(), 0);
+
+  for (uint32_t y = 0; y < height && y < board.height; y++)
+  {
+    for (uint32_t x = 0; x < width && x < board.width; x++)
+    {
+      cells[CellIndex(x, y)] = GetCell(board, x, y) ? 1 : 0;
+    }
+  }
+}
+
+PackedBoard LtlEngine::GetBoard() const
+{
+  PackedBoard board = CreatePackedBoard(width, height);
+
+  for (uint32_t y = 0; y < height; y++)
+  {
+    for (uint32_t x = 0; x < width; x++)
+    {
+      if (cells[CellIndex(x, y)] != 0)
+      {
+        ::SetCell(&board, x, y, true);
+      }
+    }
+  }
+
+  return board;
+}
+
+void LtlEngine::SetCell(uint32_t x, uint32_t y, bool alive)
+{
+  if (x < width && y < height)
+  {
+    cells[CellIndex(x, y)] = alive ? 1 : 0;
+  }
+}
+
+void LtlEngine::CopyHalo()
+{
+  // the plane's halo is never written, the torus' repeats the board, as often as the radius needs
+  if (topology != Topology::Torus)
+  {
+    return;
+  }
+
+  int64_t radius = rule.radius;
+  auto copy = [&](int64_t x, int64_t y)
+  {
+    uint32_t sourceX = uint32_t(((x % int64_t(width)) + width) % width);
+    uint32_t sourceY = uint32_t(((y % int64_t(height)) + height) % height);
+    cells[size_t(y + radius) * paddedWidth + size_t(x + radius)] = cells[CellIndex(sourceX, sourceY)];
+  };
+
+  for (int64_t y = -radius; y < int64_t(height) + radius; y++)
+  {
+    if (y >= 0 && y < int64_t(height))
+    {
+      for (int64_t x = 0; x < radius; x++)
+      {
+        copy(x - radius, y);
+        copy(int64_t(width) + x, y);
+      }
+    }
+    else
+    {
+      for (int64_t x = -radius; x < int64_t(width) + radius; x++)
+      {
+        copy(x, y);
+      }
+    }
+  }
+}
+
+void LtlEngine::BuildTable()
+{
+  size_t stride = paddedWidth + 1;
+
+  // every row on its own, a scan can't be split any further without a second pass
+  ForEachRow(paddedHeight, [&](uint32_t y)
+  {
+    const uint8_t* row = &cells[size_t(y) * paddedWidth];
+    uint32_t* out = &table[size_t(y + 1) * stride];
+
+    uint32_t sum = 0;
+    for (uint32_t x = 0; x < paddedWidth; x++)
+    {
+      sum += row[x];
+      out[x + 1] = sum;
+    }
+  });
+
+  // the rows depend on each other, but the columns within one don't
+  for (uint32_t y = 2; y <= paddedHeight; y++)
+  {
+    const uint32_t* above = &table[size_t(y - 1) * stride];
+    uint32_t* row = &table[size_t(y) * stride];
+
+    for (size_t x = 1; x < stride; x++)
+    {
+      row[x] += above[x];
+    }
+  }
+}
+
+void LtlEngine::Step()
+{
+  PROFILE_SCOPE("ltl step");
+
+  CopyHalo();
+  BuildTable();
+
+  size_t stride = paddedWidth + 1;
+  uint32_t side = 2 * rule.radius + 1;
+  uint32_t self = rule.middle ? 0 : 1;
+
+  ForEachRow(height, [&](uint32_t y)
+  {
+    // the square of cell (x, y) spans padded rows y to y + side - 1 and the same for the columns
+    const uint32_t* top = &table[size_t(y) * stride];
+    const uint32_t* bottom = &table[size_t(y + side) * stride];
+
+    for (uint32_t x = 0; x < width; x++)
+    {
+      size_t index = CellIndex(x, y);
+      uint32_t alive = cells[index];
+      uint32_t count = bottom[x + side] - bottom[x] - top[x + side] + top[x] - alive * self;
+
+      next[index] = alive != 0 ? (count >= rule.survivalMin && count <= rule.survivalMax) : (count >= rule.birthMin && count <= rule.birthMax);
+    }
+  });
+
+  cells.swap(next);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Structs.h"
+#include "Board.h"
+
+// Larger than Life on the host, a byte per cell. Every step builds a summed area table of the board
+// and its halo of radius cells, so the count of any square neighbourhood is four lookups no matter
+// how large the radius. The table is built in two passes, a scan along every row spread over the cores
+// and then a running sum down the columns, which adds whole rows at once and gets vectorized.
+class LtlEngine
+{
+private:
+  uint32_t width;
+  uint32_t height;
+  Topology topology;
+  Rule rule;
+
+  // the board with a halo of radius cells on every side, refilled every step
+  uint32_t paddedWidth;
+  uint32_t paddedHeight;
+  std::vector<uint8_t> cells;
+  std::vector<uint8_t> next;
+
+  // a row and column of zeros in front, entry (x + 1, y + 1) sums the padded cells up to (x, y)
+  std::vector<uint32_t> table;
+
+  size_t CellIndex(uint32_t x, uint32_t y) const { return size_t(y + rule.radius) * paddedWidth + x + rule.radius; }
+  void CopyHalo();
+  void BuildTable();
+
+public:
+  LtlEngine(uint32_t width, uint32_t height, Topology topology, const Rule& rule);
+
+  void SetBoard(const PackedBoard& board);
+  PackedBoard GetBoard() const;
+
+  // cells outside the board are ignored
+  void SetCell(uint32_t x, uint32_t y, bool alive);
+
+  void Step();
+};
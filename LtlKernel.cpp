@@ -0,0 +1,105 @@
+#include "LtlKernel.h"
+#include "GameOfLifeVulkan.h"
+
+#include <vector>
+
+VkResult LtlKernel::Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, uint32_t width, uint32_t height, const Rule& rule, bool heat)
+{
+  this->device = device;
+  this->vkCmdPushDescriptorSetKHR = vkCmdPushDescriptorSetKHR;
+  push = { width, height, rule.radius, rule.middle ? 1u : 0u, rule.birthMin, rule.birthMax, rule.survivalMin, rule.survivalMax, heat ? 1u : 0u };
+  cleared = false;
+
+  VkDeviceSize size = VkDeviceSize(width + 2 * rule.radius + 1) * (height + 2 * rule.radius + 1) * sizeof(uint32_t);
+  auto bufferCreation = CreateBuffer(physicalDevice, device, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  if (std::holds_alternative<VkResult>(bufferCreation))
+  {
+    return std::get<VkResult>(bufferCreation);
+  }
+  table = std::get<Buffer>(bufferCreation);
+
+  VkDescriptorSetLayoutBinding samplerBinding = CreateDescriptorSetLayoutBinding(0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT);
+  VkDescriptorSetLayoutBinding storageBinding = CreateDescriptorSetLayoutBinding(1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+  VkDescriptorSetLayoutBinding tableBinding = CreateDescriptorSetLayoutBinding(2, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+  auto descriptorSetLayoutCreation = CreateDescriptorSetLayout(device, { samplerBinding, storageBinding, tableBinding });
+  if (std::holds_alternative<VkResult>(descriptorSetLayoutCreation))
+  {
+    return std::get<VkResult>(descriptorSetLayoutCreation);
+  }
+  descriptorSetLayout = std::get<VkDescriptorSetLayout>(descriptorSetLayoutCreation);
+
+  VkPushConstantRange pushConstant = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(LtlPush) };
+  auto pipelineLayoutCreation = CreatePipelineLayout(device, { descriptorSetLayout }, { pushConstant });
+  if (std::holds_alternative<VkResult>(pipelineLayoutCreation))
+  {
+    return std::get<VkResult>(pipelineLayoutCreation);
+  }
+  pipelineLayout = std::get<VkPipelineLayout>(pipelineLayoutCreation);
+
+  std::array<const char*, 3> shaders = { "gol_ltl_rows.comp.spv", "gol_ltl_columns.comp.spv", "gol_ltl.comp.spv" };
+  for (size_t i = 0; i < shaders.size(); i++)
+  {
+    auto pipelineCreation = CreateComputePipeline(device, pipelineLayout, shaders[i]);
+    if (std::holds_alternative<VkResult>(pipelineCreation))
+    {
+      return std::get<VkResult>(pipelineCreation);
+    }
+    pipelines[i] = std::get<VkPipeline>(pipelineCreation);
+  }
+
+  return VK_SUCCESS;
+}
+
+void LtlKernel::Destroy()
+{
+  for (auto pipeline : pipelines)
+  {
+    vkDestroyPipeline(device, pipeline, nullptr);
+  }
+
+  vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+  FreeBuffer(device, table);
+}
+
+void LtlKernel::Record(VkCommandBuffer cmd, VkSampler sampler, VkImageView source, VkImageView target)
+{
+  if (!cleared)
+  {
+    vkCmdFillBuffer(cmd, table.buffer, 0, VK_WHOLE_SIZE, 0);
+    GlobalBarrier(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    cleared = true;
+  }
+
+  // the write descriptor sets only point into these
+  std::vector<VkDescriptorImageInfo> samplerInfos = { { sampler, source, VK_IMAGE_LAYOUT_GENERAL } };
+  std::vector<VkDescriptorImageInfo> storageInfos = { { VK_NULL_HANDLE, target, VK_IMAGE_LAYOUT_GENERAL } };
+  std::vector<VkDescriptorBufferInfo> tableInfos = { CreateDescriptorBufferInfo(table.buffer, 0, VK_WHOLE_SIZE) };
+
+  std::array<VkWriteDescriptorSet, 3> writeDescriptorSets = {};
+  writeDescriptorSets[0] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, {}, samplerInfos);
+  writeDescriptorSets[1] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, {}, storageInfos);
+  writeDescriptorSets[2] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 2, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, tableInfos, {});
+
+  uint32_t paddedWidth = push.width + 2 * push.radius;
+  uint32_t paddedHeight = push.height + 2 * push.radius;
+
+  // the previous step may still read the table
+  GlobalBarrier(cmd, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines[0]);
+  vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, uint32_t(writeDescriptorSets.size()), writeDescriptorSets.data());
+  vkCmdPushConstants(cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+  vkCmdDispatch(cmd, paddedHeight, 1, 1);
+
+  GlobalBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  // the descriptors and push constants stay bound, all three pipelines share the layout
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines[1]);
+  vkCmdDispatch(cmd, (paddedWidth + 255) / 256, 1, 1);
+
+  GlobalBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines[2]);
+  vkCmdDispatch(cmd, (push.width + 15) / 16, (push.height + 15) / 16, 1);
+}
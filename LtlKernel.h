@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+
+#include <vulkan/vulkan.h>
+
+#include "Structs.h"
+
+// Larger than Life on the GPU: a step records three dispatches into the caller's command buffer,
+// a scan along every row of the board and its halo into a summed area table, a running sum down
+// its columns, and the rule applied with four lookups per cell. It reads the board through the same
+// sampler as the B3/S23 kernels, so the topology is the sampler's address mode as well.
+class LtlKernel
+{
+private:
+  // layout matches the push constants of gol_ltl_rows.comp, gol_ltl_columns.comp and gol_ltl.comp
+  struct LtlPush
+  {
+    uint32_t width;
+    uint32_t height;
+    uint32_t radius;
+    uint32_t middle;
+    uint32_t birthMin;
+    uint32_t birthMax;
+    uint32_t survivalMin;
+    uint32_t survivalMax;
+    uint32_t heat;
+  };
+
+  VkDevice device;
+  PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR;
+  LtlPush push;
+
+  // a row and column of zeros in front, written once by the first step
+  Buffer table;
+  bool cleared;
+
+  VkDescriptorSetLayout descriptorSetLayout;
+  VkPipelineLayout pipelineLayout;
+  // rows, columns, rule
+  std::array<VkPipeline, 3> pipelines;
+
+public:
+  LtlKernel() = default;
+  ~LtlKernel() = default;
+
+  // heat tracks the age of every cell like the B3/S23 kernels
+  VkResult Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, uint32_t width, uint32_t height, const Rule& rule, bool heat = false);
+  void Destroy();
+
+  // both images in VK_IMAGE_LAYOUT_GENERAL, the caller orders the step against whatever else uses them
+  void Record(VkCommandBuffer cmd, VkSampler sampler, VkImageView source, VkImageView target);
+};
@@ -20,15 +20,42 @@
 #include <vector>
 #include <algorithm> 
 #include <set>
+#include <map>
 #include <unordered_set>
 #include <fstream>
 #include <array>
+#include <memory>
 #include <chrono>
+#include <cmath>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #include "Structs.h"
 #include "Camera.h"
 #include "GameOfLifeVulkan.h"
+#include "FrameScheduler.h"
+#include "Board.h"
+#include "History.h"
+#include "Readback.h"
+#include "CpuEngine.h"
+#include "LaneEngine.h"
+#include "SparseEngine.h"
+#include "LtlEngine.h"
+#include "LtlKernel.h"
+#include "GenerationsEngine.h"
+#include "StripEngine.h"
+#include "BatchEngine.h"
+#include "Distributed.h"
+#include "TripleBuffer.h"
+#include "Paint.h"
+#include "Export.h"
+#include "Upload.h"
+#include "Verify.h"
+#include "Profile.h"
+#include "OutOfCore.h"
+#include "Census.h"
 
 #if _WIN32
 #include <conio.h>
@@ -41,6 +68,10 @@ namespace po = boost::program_options;
 constexpr uint32_t WIDTH = 1920;
 constexpr uint32_t HEIGHT = 1080;
 constexpr int32_t FPS = 15;
+constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+constexpr uint32_t READBACK_SLOTS = 4;
+constexpr uint32_t PAINT_SLOTS = 2;
+constexpr uint32_t EXPORT_SLOTS = 4;
 
 #define CHECK_RESULT(result, errormessage) if (std::holds_alternative<VkResult>(result)) \
                                            { \
@@ -58,7 +89,21 @@ constexpr int32_t FPS = 15;
                                     return false; \
                                   }
 
-bool RenderInitialImage(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue graphicsQueue, uint32_t* positions, uint32_t positionCount, const Image2D& image, const Buffer& quadHostBuffer, const Buffer& quadDeviceBuffer, VkDeviceSize indexOffset, const Settings& settings);
+bool UploadBuffer(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue graphicsQueue, const Buffer& hostBuffer, const Buffer& deviceBuffer);
+bool UploadPalette(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue graphicsQueue, const Image2D& palette);
+PackedBoard InitialBoard(const Settings& settings);
+bool ReadbackImage(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue transferQueue, const Image2D& image, VkSemaphore timeline, uint64_t waitValue, std::vector<uint32_t>* texels);
+bool WriteCheckpoint(const std::string& fileName, const std::vector<uint32_t>& texels, const Settings& settings);
+bool WriteCheckpoint(const std::string& fileName, const PackedBoard& board);
+void PrintCensus(uint64_t generation, const std::vector<CensusEntry>& census);
+bool BenchmarkKernel(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue computeQueue, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, VkPipeline pipeline, VkPipelineLayout layout, VkSampler sampler, const Image2D& a, const Image2D& b, SemaphoreSubmit seedWritten, Kernel kernel, StepPush push, uint32_t generations, double* generationsPerSecond);
+int RunStrips(const Settings& settings);
+int RunBatch(const Settings& settings);
+int RunOutOfCore(const Settings& settings);
+int RunSparse(const Settings& settings);
+glm::ivec2 ScreenToCell(Camera& camera, const Settings& settings, double screenX, double screenY);
+void PaintLine(glm::ivec2 from, glm::ivec2 to, bool alive, const Settings& settings, std::vector<CellEdit>* edits);
+VkPresentModeKHR ToVkPresentMode(PresentMode mode);
 
 void error_callback(int error, const char* message)
 {
@@ -83,6 +128,186 @@ void validate(boost::any& v, const std::vector<std::string>& values, std::vector
   v = positions;
 }
 
+void validate(boost::any& v, const std::vector<std::string>& values, Topology*, int)
+{
+  const std::string& value = po::validators::get_single_string(values);
+
+  if (boost::iequals(value, "plane"))
+  {
+    v = Topology::Plane;
+  }
+  else if (boost::iequals(value, "torus"))
+  {
+    v = Topology::Torus;
+  }
+  else
+  {
+    throw po::validation_error(po::validation_error::invalid_option_value);
+  }
+}
+
+void validate(boost::any& v, const std::vector<std::string>& values, Backend*, int)
+{
+  const std::string& value = po::validators::get_single_string(values);
+
+  if (boost::iequals(value, "gpu"))
+  {
+    v = Backend::Gpu;
+  }
+  else if (boost::iequals(value, "cpu"))
+  {
+    v = Backend::Cpu;
+  }
+  else
+  {
+    throw po::validation_error(po::validation_error::invalid_option_value);
+  }
+}
+
+void validate(boost::any& v, const std::vector<std::string>& values, Kernel*, int)
+{
+  const std::string& value = po::validators::get_single_string(values);
+
+  if (boost::iequals(value, "naive"))
+  {
+    v = Kernel::Naive;
+  }
+  else if (boost::iequals(value, "tiled"))
+  {
+    v = Kernel::Tiled;
+  }
+  else if (boost::iequals(value, "multi"))
+  {
+    v = Kernel::Multi;
+  }
+  else
+  {
+    throw po::validation_error(po::validation_error::invalid_option_value);
+  }
+}
+
+void validate(boost::any& v, const std::vector<std::string>& values, ExportFormat*, int)
+{
+  const std::string& value = po::validators::get_single_string(values);
+
+  if (boost::iequals(value, "png"))
+  {
+    v = ExportFormat::Png;
+  }
+  else if (boost::iequals(value, "y4m"))
+  {
+    v = ExportFormat::Y4m;
+  }
+  else if (boost::iequals(value, "packed"))
+  {
+    v = ExportFormat::Packed;
+  }
+  else
+  {
+    throw po::validation_error(po::validation_error::invalid_option_value);
+  }
+}
+
+void validate(boost::any& v, const std::vector<std::string>& values, PresentMode*, int)
+{
+  const std::string& value = po::validators::get_single_string(values);
+
+  if (boost::iequals(value, "fifo"))
+  {
+    v = PresentMode::Fifo;
+  }
+  else if (boost::iequals(value, "mailbox"))
+  {
+    v = PresentMode::Mailbox;
+  }
+  else if (boost::iequals(value, "immediate"))
+  {
+    v = PresentMode::Immediate;
+  }
+  else
+  {
+    throw po::validation_error(po::validation_error::invalid_option_value);
+  }
+}
+
+void validate(boost::any& v, const std::vector<std::string>& values, Rule*, int)
+{
+  const std::string& value = po::validators::get_single_string(values);
+
+  // Larger than Life notation, C0 and C2 both mean two states and NM the square neighbourhood;
+  // the states are kept in at most 8 bit planes
+  static boost::regex r("R(\\d+),C(\\d+),M([01]),S(\\d+)\\.\\.(\\d+),B(\\d+)\\.\\.(\\d+)(,NM)?", boost::regex::icase);
+
+  // Generations notation, the survival digits, the birth digits and the count of states
+  static boost::regex g("([0-8]*)/([0-8]*)/(\\d+)");
+
+  boost::smatch match;
+  if (boost::iequals(value, "life") || boost::iequals(value, "B3/S23"))
+  {
+    v = LIFE_RULE;
+  }
+  else if (boost::iequals(value, "bosco"))
+  {
+    v = Rule{ 5, true, 34, 45, 34, 58, 2 };
+  }
+  else if (boost::iequals(value, "brain"))
+  {
+    v = Rule{ 1, false, 2, 2, 1, 0, 3 };
+  }
+  else if (boost::iequals(value, "starwars"))
+  {
+    v = Rule{ 1, false, 2, 2, 3, 5, 4 };
+  }
+  else if (boost::regex_match(value, match, r) && boost::lexical_cast<uint32_t>(match[1]) > 0)
+  {
+    Rule rule;
+    rule.radius = boost::lexical_cast<uint32_t>(match[1]);
+    rule.states = std::max(boost::lexical_cast<uint32_t>(match[2]), 2u);
+    rule.middle = match[3] == "1";
+    rule.survivalMin = boost::lexical_cast<uint32_t>(match[4]);
+    rule.survivalMax = boost::lexical_cast<uint32_t>(match[5]);
+    rule.birthMin = boost::lexical_cast<uint32_t>(match[6]);
+    rule.birthMax = boost::lexical_cast<uint32_t>(match[7]);
+
+    // the bit planes only count the eight neighbours and the middle
+    if (rule.states > 256 || (rule.states > 2 && rule.radius > 1))
+    {
+      throw po::validation_error(po::validation_error::invalid_option_value);
+    }
+    v = rule;
+  }
+  else if (boost::regex_match(value, match, g))
+  {
+    // only runs of digits, every rule here is a range of counts
+    auto range = [](std::string digits, uint32_t* min, uint32_t* max)
+    {
+      std::sort(digits.begin(), digits.end());
+      digits.erase(std::unique(digits.begin(), digits.end()), digits.end());
+      if (digits.empty())
+      {
+        *min = 1;
+        *max = 0;
+        return true;
+      }
+
+      *min = uint32_t(digits.front() - '0');
+      *max = uint32_t(digits.back() - '0');
+      return *max - *min + 1 == digits.size();
+    };
+
+    Rule rule = { 1, false, 0, 0, 0, 0, boost::lexical_cast<uint32_t>(match[3]) };
+    if (!range(match[1], &rule.survivalMin, &rule.survivalMax) || !range(match[2], &rule.birthMin, &rule.birthMax) || rule.states < 2 || rule.states > 256)
+    {
+      throw po::validation_error(po::validation_error::invalid_option_value);
+    }
+    v = rule;
+  }
+  else
+  {
+    throw po::validation_error(po::validation_error::invalid_option_value);
+  }
+}
+
 bool ReadSettings(int argc, char** argv, Settings* settings);
 
 std::ostream& operator<<(std::ostream& out, const glm::vec4& g)
@@ -105,6 +330,66 @@ int main(int argc, char** argv)
     GETOUT(1);
   }
 
+  if (!settings.tracePath.empty())
+  {
+#ifdef GOL_PROFILE
+    Profiler::Instance().Start(settings.tracePath);
+#else
+    std::cout << "built without GOL_PROFILE, no trace gets written" << std::endl;
+#endif
+  }
+
+  if (settings.verify)
+  {
+    return RunVerification(settings, InitialBoard(settings)) ? 0 : 1;
+  }
+
+  if (settings.devices > 0)
+  {
+    return RunStrips(settings);
+  }
+
+  if (settings.batch > 0)
+  {
+    return RunBatch(settings);
+  }
+
+  if (!settings.outOfCorePath.empty())
+  {
+    return RunOutOfCore(settings);
+  }
+
+  if (settings.sparse)
+  {
+    return RunSparse(settings);
+  }
+
+  if (settings.coordinate > 0)
+  {
+    PackedBoard board;
+    if (!RunCoordinator(settings, settings.gather ? &board : nullptr))
+    {
+      GETOUT(1);
+    }
+
+    if (settings.gather && !WriteCheckpoint("checkpoint_" + std::to_string(settings.generations) + ".txt", board))
+    {
+      std::cout << "could not write checkpoint" << std::endl;
+    }
+
+    if (settings.gather && settings.census)
+    {
+      PrintCensus(settings.generations, TakeCensus(board));
+    }
+
+    return 0;
+  }
+
+  if (!settings.join.empty())
+  {
+    return RunWorker(settings) ? 0 : 1;
+  }
+
   glfwSetErrorCallback(error_callback);
   if (glfwInit() != GLFW_TRUE)
   {
@@ -115,7 +400,7 @@ int main(int argc, char** argv)
   uint32_t count;
   auto ext = glfwGetRequiredInstanceExtensions(&count);
 
-  if (!CheckVulkanVersion(VK_API_VERSION_1_1))
+  if (!CheckVulkanVersion(VK_API_VERSION_1_2))
   {
     std::cout << "Vulkan Version is not high enough" << std::endl;
     GETOUT(1)
@@ -131,17 +416,26 @@ int main(int argc, char** argv)
   auto extensions = CheckInstanceExtensions(required);
   CHECK_RESULT(extensions, "could not get extensions");
 
-  auto creation = CreateInstance("Game of Life", VK_MAKE_VERSION(0, 1, 0), VK_API_VERSION_1_1, std::get<std::vector<const char*>>(layers), std::get<std::vector<const char*>>(extensions));
+  auto creation = CreateInstance("Game of Life", VK_MAKE_VERSION(0, 1, 0), VK_API_VERSION_1_2, std::get<std::vector<const char*>>(layers), std::get<std::vector<const char*>>(extensions));
   CHECK_RESULT(creation, "could not create instance");
 
   VkInstance instance = std::get<VkInstance>(creation);
 
   glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-  glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-  auto window = glfwCreateWindow(settings.windowWidth, settings.windowHeight, "Game of Life", nullptr, nullptr);
-  auto mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+  glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+  auto monitor = glfwGetPrimaryMonitor();
+  auto window = glfwCreateWindow(settings.windowWidth, settings.windowHeight, "Game of Life", settings.fullScreen ? monitor : nullptr, nullptr);
+  if (!window)
+  {
+    std::cout << "could not create window" << std::endl;
+    GETOUT(1);
+  }
 
-  glfwSetWindowPos(window, (mode->width - settings.windowWidth) / 2, (mode->height - settings.windowHeight) / 2);
+  if (!settings.fullScreen)
+  {
+    auto mode = glfwGetVideoMode(monitor);
+    glfwSetWindowPos(window, (mode->width - settings.windowWidth) / 2, (mode->height - settings.windowHeight) / 2);
+  }
 
   VkSurfaceKHR surface;
   auto result = glfwCreateWindowSurface(instance, window, nullptr, &surface);
@@ -163,14 +457,26 @@ int main(int argc, char** argv)
 
   VkPhysicalDeviceFeatures features = {};
   features.fragmentStoresAndAtomics = VK_TRUE;
-  auto deviceCreation = CreateLogicalDevice(physicalDevice, &features);
+
+  // timeline semaphores order the compute, transfer and graphics queues against each other
+  VkPhysicalDeviceVulkan12Features features12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+  features12.pNext = nullptr;
+  features12.timelineSemaphore = VK_TRUE;
+
+  auto deviceCreation = CreateLogicalDevice(physicalDevice, &features, &features12);
   CHECK_RESULT(deviceCreation, "could not create logical device");
 
   VkDevice device = std::get<VkDevice>(deviceCreation);
   VkQueue graphicsQueue;
   VkQueue presentationQueue;
+  VkQueue computeQueue;
+  VkQueue transferQueue;
   vkGetDeviceQueue(device, physicalDevice.graphicsQueueIndex, 0, &graphicsQueue);
   vkGetDeviceQueue(device, physicalDevice.presentationQueueIndex, 0, &presentationQueue);
+  vkGetDeviceQueue(device, physicalDevice.computeQueueIndex, 0, &computeQueue);
+  vkGetDeviceQueue(device, physicalDevice.transferQueueIndex, 0, &transferQueue);
+
+  std::vector<uint32_t> boardQueueFamilies = { physicalDevice.graphicsQueueIndex, physicalDevice.computeQueueIndex, physicalDevice.transferQueueIndex };
 
   vkCmdPushDescriptorSetKHR = (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr(device, "vkCmdPushDescriptorSetKHR");
   if (!vkCmdPushDescriptorSetKHR)
@@ -193,16 +499,19 @@ int main(int argc, char** argv)
   deviceProps2.pNext = &pushDescriptorProps;
   vkGetPhysicalDeviceProperties2KHR(physicalDevice, &deviceProps2);
 
-  auto swapchainCreation = CreateSwapchain(physicalDevice, surface, device, { settings.windowWidth, settings.windowHeight });
-  CHECK_RESULT(layers, "could not create swapchain");
+  VkPresentModeKHR presentMode = ToVkPresentMode(settings.presentMode);
+
+  // fullscreen picks the closest video mode, so the extent comes from the window and not from the settings
+  int framebufferWidth, framebufferHeight;
+  glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+
+  auto swapchainCreation = CreateSwapchain(physicalDevice, surface, device, { uint32_t(framebufferWidth), uint32_t(framebufferHeight) }, presentMode);
+  CHECK_RESULT(swapchainCreation, "could not create swapchain");
   Swapchain swapchain = std::get<Swapchain>(swapchainCreation);
 
-  for (size_t i = 0; i < swapchain.images.size(); i++)
+  if (swapchain.presentMode != presentMode)
   {
-    auto imageView = CreateImageView2D(device, swapchain.images[i], swapchain.format);
-    CHECK_RESULT(imageView, "could not create swapchain image");
-
-    swapchain.imageViews[i] = std::get<VkImageView>(imageView);
+    std::cout << "present mode not supported, falling back to fifo" << std::endl;
   }
 
   Ubo ubo = {};
@@ -213,11 +522,23 @@ int main(int argc, char** argv)
   double xpos, ypos;
   glfwGetCursorPos(window, &xpos, &ypos);
 
+  // written by the callbacks on the main thread, consumed by the simulation thread
   struct Control
   {
-    int32_t fpsOffset = 0;
-    bool paused = false;
+    std::atomic<int32_t> fpsOffset = 0;
+    std::atomic<bool> paused = false;
+    std::atomic<bool> checkpoint = false;
+    std::atomic<bool> census = false;
+    std::atomic<bool> diff = false;
+    std::atomic<bool> reseed = false;
+    std::atomic<int32_t> scrub = 0;
     glm::vec2 lastMousePos;
+    // the swapchain follows the window, only touched on the main thread
+    bool resized = false;
+    // painted cells of the current frame, only touched on the main thread
+    bool painting = false;
+    glm::ivec2 lastPaintCell;
+    std::vector<CellEdit> strokes;
     Camera* cam;
     Settings* settings;
   } control;
@@ -259,24 +580,76 @@ int main(int argc, char** argv)
       ctrl->lastMousePos.x = float(xpos);
       ctrl->lastMousePos.y = float(ypos);
     }
+
+    // the right button paints, with shift it erases
+    if (ctrl->painting)
+    {
+      glm::ivec2 cell = ScreenToCell(*ctrl->cam, *ctrl->settings, xpos, ypos);
+      bool alive = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) != GLFW_PRESS;
+
+      PaintLine(ctrl->lastPaintCell, cell, alive, *ctrl->settings, &ctrl->strokes);
+      ctrl->lastPaintCell = cell;
+    }
   };
   glfwSetCursorPosCallback(window, onMouseMove);
 
-  Image2D image1, image2;
+  auto onMouseButton = [](GLFWwindow* window, int button, int action, int mods)
+  {
+    Control* ctrl = (Control*)glfwGetWindowUserPointer(window);
+
+    if (button != GLFW_MOUSE_BUTTON_RIGHT)
+    {
+      return;
+    }
+
+    ctrl->painting = action == GLFW_PRESS;
+    if (ctrl->painting)
+    {
+      double xpos, ypos;
+      glfwGetCursorPos(window, &xpos, &ypos);
+
+      glm::ivec2 cell = ScreenToCell(*ctrl->cam, *ctrl->settings, xpos, ypos);
+      PaintLine(cell, cell, !(mods & GLFW_MOD_SHIFT), *ctrl->settings, &ctrl->strokes);
+      ctrl->lastPaintCell = cell;
+    }
+  };
+  glfwSetMouseButtonCallback(window, onMouseButton);
+
+  auto onFramebufferSize = [](GLFWwindow* window, int width, int height)
+  {
+    Control* ctrl = (Control*)glfwGetWindowUserPointer(window);
+    ctrl->resized = true;
+  };
+  glfwSetFramebufferSizeCallback(window, onFramebufferSize);
+
+  FrameScheduler scheduler;
+  result = scheduler.Create(device, FRAMES_IN_FLIGHT, settings.runAhead, settings.throughput);
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not create frame scheduler: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
+  }
 
-  VkImageUsageFlags imgUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-  auto imageCreation = CreateImage2D(physicalDevice, device, VK_FORMAT_R8G8B8A8_UNORM, settings.imageWidth, settings.imageHeight, imgUsage, VK_IMAGE_LAYOUT_UNDEFINED);
-  CHECK_RESULT(imageCreation, "could not create image1");
-  image1 = std::get<Image2D>(imageCreation);
+  // one board image per scheduler slot, generation g lives in boardImages[scheduler.Slot(g)]
+  std::vector<Image2D> boardImages(scheduler.SlotCount());
 
-  imageCreation = CreateImage2D(physicalDevice, device, VK_FORMAT_R8G8B8A8_UNORM, settings.imageWidth, settings.imageHeight, imgUsage, VK_IMAGE_LAYOUT_UNDEFINED);
-  CHECK_RESULT(imageCreation, "could not create image2");
-  image2 = std::get<Image2D>(imageCreation);
+  VkImageUsageFlags imgUsage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+  for (auto& boardImage : boardImages)
+  {
+    auto imageCreation = CreateImage2D(physicalDevice, device, VK_FORMAT_R8G8B8A8_UNORM, settings.imageWidth, settings.imageHeight, imgUsage, VK_IMAGE_LAYOUT_UNDEFINED, boardQueueFamilies);
+    CHECK_RESULT(imageCreation, "could not create board image");
+    boardImage = std::get<Image2D>(imageCreation);
+  }
 
 
-  auto uboBufferCreation = CreateBuffer(physicalDevice, device, sizeof(Ubo), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-  CHECK_RESULT(uboBufferCreation, "could not create ubo buffer");
-  Buffer uboBuffer = std::get<Buffer>(uboBufferCreation);
+  // one per frame in flight, the host only writes a frame's ubo once BeginFrame has waited for its last present pass
+  std::vector<Buffer> uboBuffers;
+  for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; i++)
+  {
+    auto uboBufferCreation = CreateBuffer(physicalDevice, device, sizeof(Ubo), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    CHECK_RESULT(uboBufferCreation, "could not create ubo buffer");
+    uboBuffers.push_back(std::get<Buffer>(uboBufferCreation));
+  }
 
   float imageOffsetX = 0.0f, imageOffsetY = 0.0f;
   //float ratio = float(settings.imageWidth) / float(settings.imageHeight);
@@ -335,23 +708,66 @@ int main(int argc, char** argv)
   memcpy(data, indices.data(), indexSize);
   vkUnmapMemory(device, hostBuffer.memory);
 
-  std::vector<uint32_t> positions(settings.imageWidth * settings.imageHeight);
+  PackedBoard seedBoard = InitialBoard(settings);
 
-  for (auto& pos : settings.positions)
+  // only steps with --Backend cpu, the images then just get the uploaded result
+  CpuEngine cpuEngine(settings.imageWidth, settings.imageHeight, settings.topology);
+  cpuEngine.SetBoard(seedBoard);
+
+  // any other rule than B3/S23 steps through a summed area table instead, on either backend;
+  // Generations rules only on the cpu, in bit planes
+  bool life = IsLife(settings.rule);
+  std::unique_ptr<LtlEngine> ltlEngine;
+  std::unique_ptr<GenerationsEngine> generationsEngine;
+  if (settings.rule.states > 2)
+  {
+    generationsEngine = std::make_unique<GenerationsEngine>(settings.imageWidth, settings.imageHeight, settings.topology, settings.rule);
+    generationsEngine->SetBoard(seedBoard);
+  }
+  else if (!life && settings.backend == Backend::Cpu)
+  {
+    ltlEngine = std::make_unique<LtlEngine>(settings.imageWidth, settings.imageHeight, settings.topology, settings.rule);
+    ltlEngine->SetBoard(seedBoard);
+  }
+
+  auto cpuBoard = [&]() -> PackedBoard
+  {
+    if (generationsEngine)
+    {
+      return generationsEngine->GetBoard();
+    }
+    return ltlEngine ? ltlEngine->GetBoard() : cpuEngine.GetBoard();
+  };
+
+  if (!UploadBuffer(physicalDevice, device, graphicsQueue, hostBuffer, deviceBuffer))
   {
-    uint32_t index = pos.x + pos.y * settings.imageWidth;
+    std::cout << "could not upload quad data" << std::endl;
+    GETOUT(1);
+  }
 
-    positions[index] = 0xFFFFFFFF;
+  // seeds and host steps only upload the packed board, the compute queue expands it into the image
+  BoardUploader uploader;
+  result = uploader.Create(physicalDevice, device, vkCmdPushDescriptorSetKHR, settings.imageWidth, settings.imageHeight);
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not create board uploader: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
   }
 
-  bool b = RenderInitialImage(physicalDevice, device, graphicsQueue, positions.data(), uint32_t(positions.size()), image1, hostBuffer, deviceBuffer, vertexSize, settings);
-  if (!b)
+  // a seed is just another generation on the timeline, it never goes backwards
+  std::vector<SemaphoreSubmit> seedWaits;
+  uint64_t seedGeneration = scheduler.BeginGeneration(&seedWaits, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  result = uploader.Upload(computeQueue, seedBoard, boardImages[scheduler.Slot(seedGeneration)], seedWaits, scheduler.EndGeneration(seedGeneration));
+  if (result != VK_SUCCESS)
   {
-    std::cout << "could not render initial image" << std::endl;
+    std::cout << "could not upload initial board: VkResult = " << VkResultToString(result) << std::endl;
     GETOUT(1);
   }
 
-  auto samplerCreation = CreateSampler(device, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER, 1, VK_TRUE);
+  // dead cells beyond the edges of the plane, the opposite edge for the torus
+  VkSamplerAddressMode boardAddressMode = settings.topology == Topology::Torus ? VK_SAMPLER_ADDRESS_MODE_REPEAT : VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+  auto samplerCreation = CreateSampler(device, VK_FILTER_NEAREST, boardAddressMode, 1, VK_FALSE, VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK);
   CHECK_RESULT(samplerCreation, "could not create sampler");
   VkSampler sampler = std::get<VkSampler>(samplerCreation);
 
@@ -359,405 +775,1821 @@ int main(int argc, char** argv)
   CHECK_RESULT(samplerCreation, "could not create sampler");
   VkSampler presentSampler = std::get<VkSampler>(samplerCreation);
 
-  VkDescriptorSetLayoutBinding binding = CreateDescriptorSetLayoutBinding(0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
-  auto descriptorSetLayoutCreation = CreateDescriptorSetLayout(device, { binding });
+  // the colors of the ages with Heatmap, always bound since present.frag uses it either way
+  auto paletteCreation = CreateImage2D(physicalDevice, device, VK_FORMAT_R8G8B8A8_UNORM, 256, 1, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+  CHECK_RESULT(paletteCreation, "could not create palette image");
+  Image2D palette = std::get<Image2D>(paletteCreation);
+
+  if (!UploadPalette(physicalDevice, device, graphicsQueue, palette))
+  {
+    std::cout << "could not upload palette" << std::endl;
+    GETOUT(1);
+  }
+
+  samplerCreation = CreateSampler(device, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, 1, VK_FALSE);
+  CHECK_RESULT(samplerCreation, "could not create sampler");
+  VkSampler paletteSampler = std::get<VkSampler>(samplerCreation);
+
+  VkDescriptorSetLayoutBinding binding = CreateDescriptorSetLayoutBinding(0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT);
+  VkDescriptorSetLayoutBinding storageBinding = CreateDescriptorSetLayoutBinding(1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+  auto descriptorSetLayoutCreation = CreateDescriptorSetLayout(device, { binding, storageBinding });
   CHECK_RESULT(descriptorSetLayoutCreation, "could not create VkDescriptorSetLayout");
   VkDescriptorSetLayout descriptorSetLayout = std::get<VkDescriptorSetLayout>(descriptorSetLayoutCreation);
 
-  auto piplineLayoutCreation = CreatePipelineLayout(device, { descriptorSetLayout }, {});
+  VkPushConstantRange stepPushRange = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(StepPush) };
+  auto piplineLayoutCreation = CreatePipelineLayout(device, { descriptorSetLayout }, { stepPushRange });
   CHECK_RESULT(piplineLayoutCreation, "could not create VkPipelineLayout");
   VkPipelineLayout pipelineLayout = std::get<VkPipelineLayout>(piplineLayoutCreation);
 
   VkDescriptorSetLayoutBinding uboBinding = CreateDescriptorSetLayoutBinding(0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT);
   VkDescriptorSetLayoutBinding textureBinding = CreateDescriptorSetLayoutBinding(1, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+  VkDescriptorSetLayoutBinding paletteBinding = CreateDescriptorSetLayoutBinding(2, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
 
-  descriptorSetLayoutCreation = CreateDescriptorSetLayout(device, { uboBinding, textureBinding });
+  descriptorSetLayoutCreation = CreateDescriptorSetLayout(device, { uboBinding, textureBinding, paletteBinding });
   CHECK_RESULT(descriptorSetLayoutCreation, "could not create VkDescriptorSetLayout");
   VkDescriptorSetLayout presentDescriptorSetLayout = std::get<VkDescriptorSetLayout>(descriptorSetLayoutCreation);
 
-  piplineLayoutCreation = CreatePipelineLayout(device, { presentDescriptorSetLayout }, {});
+  VkPushConstantRange presentPushRange = { VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t) };
+  piplineLayoutCreation = CreatePipelineLayout(device, { presentDescriptorSetLayout }, { presentPushRange });
   CHECK_RESULT(piplineLayoutCreation, "could not create VkPipelineLayout");
   VkPipelineLayout presentPipelineLayout = std::get<VkPipelineLayout>(piplineLayoutCreation);
 
+  // the board images never leave VK_IMAGE_LAYOUT_GENERAL, they get sampled, stored and copied on three queues
   VkDescriptorImageInfo golImageDescriptor = {};
-  golImageDescriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  golImageDescriptor.imageView = image2.view;
+  golImageDescriptor.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+  golImageDescriptor.imageView = VK_NULL_HANDLE;
   golImageDescriptor.sampler = sampler;
 
+  VkDescriptorImageInfo golStorageDescriptor = {};
+  golStorageDescriptor.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+  golStorageDescriptor.imageView = VK_NULL_HANDLE;
+  golStorageDescriptor.sampler = VK_NULL_HANDLE;
+
   VkDescriptorImageInfo presentImageDescriptor = {};
-  presentImageDescriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  presentImageDescriptor.imageView = image1.view;
+  presentImageDescriptor.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+  presentImageDescriptor.imageView = VK_NULL_HANDLE;
   presentImageDescriptor.sampler = presentSampler;
 
+  VkDescriptorImageInfo paletteDescriptor = {};
+  paletteDescriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  paletteDescriptor.imageView = palette.view;
+  paletteDescriptor.sampler = paletteSampler;
+  uint32_t presentHeat = settings.heatmap ? 1u : 0u;
+
   VkDescriptorBufferInfo uboBufferInfo = {};
   uboBufferInfo.offset = 0;
   uboBufferInfo.range = sizeof(Ubo);
-  uboBufferInfo.buffer = uboBuffer.buffer;
-
-  Image2D *images[] = { &image2, &image1 };
 
-  auto attachment = CreateAttachementDescription(image1.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-  //auto attachment = CreateAttachementDescription(image1.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
   std::vector<VkAttachmentReference> references = { { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL } };
   auto subpass = CreateSubpass(VK_PIPELINE_BIND_POINT_GRAPHICS, references, nullptr);
   auto dependencies = CreateDefaultSubpassDependencies(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
-  auto renderPassCreation = CreateRenderPass(device, { attachment }, { subpass }, dependencies);
-  CHECK_RESULT(renderPassCreation, "could not create renderPass (background draw)");
-  auto renderPassGoL = std::get<VkRenderPass>(renderPassCreation);
-
-  attachment = CreateAttachementDescription(swapchain.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-  renderPassCreation = CreateRenderPass(device, { attachment }, { subpass }, dependencies);
-  CHECK_RESULT(renderPassCreation, "could not create renderPass (present)");
-  auto renderPass = std::get<VkRenderPass>(renderPassCreation);
-
-  auto pipelineCreation = CreatePipeline(device, pipelineLayout, { settings.imageWidth, settings.imageHeight }, renderPassGoL, "init.vert.spv", "gol.frag.spv");
-  CHECK_RESULT(pipelineCreation, "could not create pipeline (background draw)");
-  auto pipelineGoL = std::get<VkPipeline>(pipelineCreation);
 
-  pipelineCreation = CreatePipeline(device, presentPipelineLayout, { settings.windowWidth, settings.windowHeight }, renderPass, "present.vert.spv", "present.frag.spv");
-  CHECK_RESULT(pipelineCreation, "could not create pipeline (present)");
-  auto pipeline = std::get<VkPipeline>(pipelineCreation);
+  auto pipelineCreation = CreateComputePipeline(device, pipelineLayout, "gol.comp.spv");
+  CHECK_RESULT(pipelineCreation, "could not create pipeline (simulation)");
+  auto pipelineNaive = std::get<VkPipeline>(pipelineCreation);
 
-  // create command buffer
-  auto commandPoolCreation = CreateCommandPool(device, physicalDevice.graphicsQueueIndex);
-  CHECK_RESULT(commandPoolCreation, "could not create command pool");
-  auto commandPool = std::get<VkCommandPool>(commandPoolCreation);
+  pipelineCreation = CreateComputePipeline(device, pipelineLayout, "gol_tiled.comp.spv");
+  CHECK_RESULT(pipelineCreation, "could not create pipeline (tiled simulation)");
+  auto pipelineTiled = std::get<VkPipeline>(pipelineCreation);
 
-  std::vector<VkCommandBuffer> commands;
-  commands.resize(swapchain.images.size());
+  pipelineCreation = CreateComputePipeline(device, pipelineLayout, "gol_multi.comp.spv");
+  CHECK_RESULT(pipelineCreation, "could not create pipeline (multi generation simulation)");
+  auto pipelineMulti = std::get<VkPipeline>(pipelineCreation);
 
-  result = AllocateCommandBuffer(device, commandPool, uint32_t(commands.size()), commands.data());
-  if (result != VK_SUCCESS)
+  auto pipelineOf = [&](Kernel kernel) -> VkPipeline
   {
-    std::cout << "could not allocate command buffers" << std::endl;
-    GETOUT(1);
-  }
-
-  VkCommandBuffer command = commands[0];
+    switch (kernel)
+    {
+    case Kernel::Naive:
+      return pipelineNaive;
+    case Kernel::Tiled:
+      return pipelineTiled;
+    case Kernel::Multi:
+      return pipelineMulti;
+    }
 
-  VkSemaphore imageAvailableSemaphore, renderFinishedSemaphore;
-  VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
-  semaphoreInfo.pNext = nullptr;
-  semaphoreInfo.flags = 0;
+    return pipelineTiled;
+  };
 
-  result = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphore);
-  if (result != VK_SUCCESS)
-  {
-    GETOUT(1);
-  }
+  auto pipelineGoL = pipelineOf(settings.kernel);
 
-  result = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphore);
-  if (result != VK_SUCCESS)
+  LtlKernel ltlKernel;
+  if (!life)
   {
-    GETOUT(1);
+    result = ltlKernel.Create(physicalDevice, device, vkCmdPushDescriptorSetKHR, settings.imageWidth, settings.imageHeight, settings.rule, settings.heatmap);
+    if (result != VK_SUCCESS)
+    {
+      std::cout << "could not create the larger than life kernel: VkResult = " << VkResultToString(result) << std::endl;
+      GETOUT(1);
+    }
   }
 
-  auto fenceCreation = CreateFence(device);
-  VkFence fence = std::get<VkFence>(fenceCreation);
+  // every step on the timeline advances the board by that many generations, only the multi kernel takes more than one at once
+  uint32_t generationsPerStep = settings.backend == Backend::Gpu && settings.kernel == Kernel::Multi && life ? settings.stepsPerDispatch : 1;
+  StepPush stepPush = { generationsPerStep, settings.topology == Topology::Torus ? 1u : 0u, settings.heatmap ? 1u : 0u };
+  uint32_t stepTile = KernelTile(settings.kernel, generationsPerStep);
 
-  std::vector<VkDescriptorImageInfo> descriptorImageInfos = { golImageDescriptor };
+  // everything sized or formatted after the swapchain is rebuilt with it
+  VkRenderPass renderPass = VK_NULL_HANDLE;
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  std::vector<VkFramebuffer> framebuffers;
 
-  auto onKeyPressed = [](GLFWwindow* window, int key, int scancode, int action, int mods) -> void
+  auto createPresentTargets = [&]() -> VkResult
   {
-    Control* ctrl = (Control*)glfwGetWindowUserPointer(window);
+    for (size_t i = 0; i < swapchain.images.size(); i++)
+    {
+      auto imageView = CreateImageView2D(device, swapchain.images[i], swapchain.format);
+      CHECK_RESULT_INTERNAL(imageView);
+      swapchain.imageViews[i] = std::get<VkImageView>(imageView);
+    }
 
-    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    auto attachment = CreateAttachementDescription(swapchain.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    auto renderPassCreation = CreateRenderPass(device, { attachment }, { subpass }, dependencies);
+    CHECK_RESULT_INTERNAL(renderPassCreation);
+    renderPass = std::get<VkRenderPass>(renderPassCreation);
+
+    auto presentPipelineCreation = CreatePipeline(device, presentPipelineLayout, swapchain.extent, renderPass, "present.vert.spv", "present.frag.spv");
+    CHECK_RESULT_INTERNAL(presentPipelineCreation);
+    pipeline = std::get<VkPipeline>(presentPipelineCreation);
+
+    // framebuffers live as long as the swapchain, frames in flight may still use them
+    framebuffers.resize(swapchain.imageViews.size());
+    for (size_t i = 0; i < framebuffers.size(); i++)
     {
-      ctrl->paused = !ctrl->paused;
+      auto framebufferCreation = CreateFramebuffer(device, renderPass, swapchain.extent.width, swapchain.extent.height, { swapchain.imageViews[i] });
+      CHECK_RESULT_INTERNAL(framebufferCreation);
+      framebuffers[i] = std::get<VkFramebuffer>(framebufferCreation);
     }
 
-    if (key == GLFW_KEY_KP_ADD)
+    camera.Resize(swapchain.extent);
+    return VK_SUCCESS;
+  };
+
+  auto destroyPresentTargets = [&]()
+  {
+    for (auto framebuffer : framebuffers)
     {
-      ctrl->fpsOffset += 1;
-      if (ctrl->fpsOffset + FPS == 0 || ctrl->fpsOffset == FPS)
-      {
-        ctrl->fpsOffset += 1;
-      }
+      vkDestroyFramebuffer(device, framebuffer, nullptr);
     }
 
-    if (key == GLFW_KEY_KP_SUBTRACT)
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyRenderPass(device, renderPass, nullptr);
+
+    for (auto& imageView : swapchain.imageViews)
     {
-      ctrl->fpsOffset -= 1;
-      if (ctrl->fpsOffset + FPS == 0 || ctrl->fpsOffset == FPS)
-      {
-        ctrl->fpsOffset -= 1;
-      }
+      vkDestroyImageView(device, imageView, nullptr);
     }
-    std::cout << ctrl->fpsOffset << std::endl;
   };
-  glfwSetKeyCallback(window, onKeyPressed);
 
-  auto start = std::chrono::system_clock::now();
-  while (!glfwWindowShouldClose(window))
+  result = createPresentTargets();
+  if (result != VK_SUCCESS)
   {
-    glfwPollEvents();
+    std::cout << "could not create present targets: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
+  }
 
-    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
+  // on resize and whenever the surface reports the swapchain as out of date; steps go on meanwhile
+  auto recreateSwapchain = [&]() -> VkResult
+  {
+    // a minimized window has no extent, there is nothing to present until it comes back
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    while ((width == 0 || height == 0) && !glfwWindowShouldClose(window))
     {
-      bool b = RenderInitialImage(physicalDevice, device, graphicsQueue, positions.data(), uint32_t(positions.size()), *images[1], hostBuffer, deviceBuffer, vertexSize, settings);
-      if (!b)
-      {
-        std::cout << "could not render initial image" << std::endl;
-        break;
-      }
+      glfwWaitEvents();
+      glfwGetFramebufferSize(window, &width, &height);
     }
 
-    if (control.paused) continue;
-
-    auto current = std::chrono::system_clock::now();
-    auto d = current - start;
-    auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(d);
+    // only the frames have to be done with the targets, the compute queue keeps stepping
+    {
+      std::lock_guard<std::mutex> lock(QueueMutex(graphicsQueue));
+      vkQueueWaitIdle(graphicsQueue);
+    }
 
+    if (presentationQueue != graphicsQueue)
+    {
+      std::lock_guard<std::mutex> lock(QueueMutex(presentationQueue));
+      vkQueueWaitIdle(presentationQueue);
+    }
 
-    // write ubo
-    ubo.mat = camera.WorldToScreenMatrix();
+    destroyPresentTargets();
 
-    void* uboData;
-    vkMapMemory(device, uboBuffer.memory, 0, sizeof(Ubo), 0, &uboData);
-    memcpy(uboData, &ubo, sizeof(Ubo));
-    vkUnmapMemory(device, uboBuffer.memory);
+    auto recreation = CreateSwapchain(physicalDevice, surface, device, { uint32_t(width), uint32_t(height) }, presentMode, swapchain.swapchain);
+    CHECK_RESULT_INTERNAL(recreation);
 
-    vkResetCommandBuffer(command, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+    vkDestroySwapchainKHR(device, swapchain.swapchain, nullptr);
+    swapchain = std::get<Swapchain>(recreation);
 
-    uint32_t imageIndex;
-    vkAcquireNextImageKHR(device, swapchain.swapchain, std::numeric_limits<uint64_t>::max(), imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+    return createPresentTargets();
+  };
 
-    auto framebufferCreation = CreateFramebuffer(device, renderPass, settings.windowWidth, settings.windowHeight, { swapchain.imageViews[imageIndex] });
-    if (std::holds_alternative<VkResult>(framebufferCreation))
-    {
-      // bad things happened
+  // create command buffer
+  auto commandPoolCreation = CreateCommandPool(device, physicalDevice.graphicsQueueIndex);
+  CHECK_RESULT(commandPoolCreation, "could not create command pool");
+  auto commandPool = std::get<VkCommandPool>(commandPoolCreation);
+
+  std::vector<VkCommandBuffer> commands;
+  commands.resize(FRAMES_IN_FLIGHT);
+
+  result = AllocateCommandBuffer(device, commandPool, uint32_t(commands.size()), commands.data());
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not allocate command buffers" << std::endl;
+    GETOUT(1);
+  }
+
+  // simulation steps get their own pool on the (possibly dedicated) compute family
+  commandPoolCreation = CreateCommandPool(device, physicalDevice.computeQueueIndex);
+  CHECK_RESULT(commandPoolCreation, "could not create compute command pool");
+  auto computeCommandPool = std::get<VkCommandPool>(commandPoolCreation);
+
+  // one per slot, the buffer of a slot is free again once the generation previously written into it is complete
+  std::vector<VkCommandBuffer> computeCommands(scheduler.SlotCount());
+  result = AllocateCommandBuffer(device, computeCommandPool, uint32_t(computeCommands.size()), computeCommands.data());
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not allocate compute command buffers" << std::endl;
+    GETOUT(1);
+  }
+
+#ifdef GOL_PROFILE
+  // timestamps around every step and every frame, on the queues they run on
+  GpuProfiler computeProfiler;
+  result = computeProfiler.Create(physicalDevice, device, computeQueue, physicalDevice.computeQueueIndex, "compute queue");
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not create compute profiler: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
+  }
+
+  GpuProfiler graphicsProfiler;
+  result = graphicsProfiler.Create(physicalDevice, device, graphicsQueue, physicalDevice.graphicsQueueIndex, "graphics queue");
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not create graphics profiler: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
+  }
+#endif
+
+  if (settings.benchmark > 0)
+  {
+    // one generation per sweep over the board against a block of generations per pass over tiles
+    for (bool blocked : { false, true })
+    {
+      CpuEngine engine(settings.imageWidth, settings.imageHeight, settings.topology);
+      engine.SetBoard(seedBoard);
+
+      auto start = std::chrono::steady_clock::now();
+      if (blocked)
+      {
+        engine.StepBlocked(settings.benchmark);
+      }
+      else
+      {
+        for (uint32_t generation = 0; generation < settings.benchmark; generation++)
+        {
+          engine.Step();
+        }
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+      double generationsPerSecond = settings.benchmark / elapsed.count();
+      std::cout << (blocked ? "cpu blocked: " : "cpu sweep: ") << generationsPerSecond << " generations/s, " << generationsPerSecond * settings.imageWidth * settings.imageHeight / 1e9 << " Gcells/s" << std::endl;
+    }
+
+    // steps from the seed on the compute queue alone, nothing gets presented
+    const Image2D& a = boardImages[scheduler.Slot(seedGeneration)];
+    const Image2D& b = boardImages[scheduler.Slot(seedGeneration + 1)];
+    SemaphoreSubmit seedWritten = scheduler.EndGeneration(seedGeneration);
+    seedWritten.stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    for (auto kernel : { std::make_pair("naive", Kernel::Naive), std::make_pair("tiled", Kernel::Tiled), std::make_pair("multi", Kernel::Multi) })
+    {
+      StepPush push = { kernel.second == Kernel::Multi ? settings.stepsPerDispatch : 1, stepPush.wrap };
+
+      double generationsPerSecond;
+      if (!BenchmarkKernel(physicalDevice, device, computeQueue, vkCmdPushDescriptorSetKHR, pipelineOf(kernel.second), pipelineLayout, sampler, a, b, seedWritten, kernel.second, push, settings.benchmark, &generationsPerSecond))
+      {
+        std::cout << "could not benchmark the " << kernel.first << " kernel" << std::endl;
+        GETOUT(1);
+      }
+
+      std::cout << kernel.first << " kernel: " << generationsPerSecond << " generations/s, " << generationsPerSecond * a.width * a.height / 1e9 << " Gcells/s" << std::endl;
+    }
+
+    glfwSetWindowShouldClose(window, GLFW_TRUE);
+  }
+
+  std::vector<VkDescriptorImageInfo> descriptorImageInfos = { golImageDescriptor };
+  std::vector<VkDescriptorImageInfo> storageImageInfos = { golStorageDescriptor };
+
+  auto stepGenerationCpu = [&]() -> VkResult
+  {
+    if (generationsEngine)
+    {
+      generationsEngine->Step();
+    }
+    else if (ltlEngine)
+    {
+      ltlEngine->Step();
+    }
+    else
+    {
+      cpuEngine.Step();
+    }
+
+    std::vector<SemaphoreSubmit> waits;
+    uint64_t generation = scheduler.BeginGeneration(&waits, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    return uploader.Upload(computeQueue, cpuBoard(), boardImages[scheduler.Slot(generation)], waits, scheduler.EndGeneration(generation));
+  };
+
+  auto stepGeneration = [&]() -> VkResult
+  {
+    if (settings.backend == Backend::Cpu)
+    {
+      return stepGenerationCpu();
+    }
+
+    PROFILE_SCOPE("record step");
+
+    std::vector<SemaphoreSubmit> waits;
+    uint64_t generation = scheduler.BeginGeneration(&waits, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    uint32_t slot = scheduler.Slot(generation);
+    VkCommandBuffer computeCommand = computeCommands[slot];
+
+    if (generation > scheduler.SlotCount())
+    {
+      // normally long done, the run ahead bound keeps the slots apart
+      scheduler.WaitForGeneration(generation - scheduler.SlotCount());
+    }
+
+    descriptorImageInfos[0].imageView = boardImages[scheduler.Slot(generation - 1)].view;
+    storageImageInfos[0].imageView = boardImages[slot].view;
+
+    vkResetCommandBuffer(computeCommand, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+    BeginCommandBuffer(computeCommand, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    PROFILE_GPU_BEGIN(stepQuery, computeProfiler, computeCommand, "step", generation);
+
+    // the previous content of the target gets fully overwritten, once earlier readbacks on this queue are done with it
+    TransitionImageLayout(computeCommand, boardImages[slot].image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    if (life)
+    {
+      std::array<VkWriteDescriptorSet, 2> writeDescriptorSets = {};
+      writeDescriptorSets[0] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, {}, descriptorImageInfos);
+      writeDescriptorSets[1] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, {}, storageImageInfos);
+
+      vkCmdBindPipeline(computeCommand, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineGoL);
+      vkCmdPushDescriptorSetKHR(computeCommand, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, uint32_t(writeDescriptorSets.size()), writeDescriptorSets.data());
+      vkCmdPushConstants(computeCommand, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(stepPush), &stepPush);
+      vkCmdDispatch(computeCommand, (settings.imageWidth + stepTile - 1) / stepTile, (settings.imageHeight + stepTile - 1) / stepTile, 1);
+    }
+    else
+    {
+      ltlKernel.Record(computeCommand, sampler, descriptorImageInfos[0].imageView, storageImageInfos[0].imageView);
+    }
+
+    PROFILE_GPU_END(stepQuery, computeProfiler, computeCommand);
+    vkEndCommandBuffer(computeCommand);
+
+    // runs on the compute queue next to the present submits, ordered only by the timelines
+    return QueueSubmit(computeQueue, computeCommand, waits, { scheduler.EndGeneration(generation) });
+  };
+
+  auto onKeyPressed = [](GLFWwindow* window, int key, int scancode, int action, int mods) -> void
+  {
+    Control* ctrl = (Control*)glfwGetWindowUserPointer(window);
+
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+      ctrl->paused = !ctrl->paused;
+    }
+
+    if (key == GLFW_KEY_C && action == GLFW_PRESS)
+    {
+      ctrl->checkpoint = true;
+    }
+
+    if (key == GLFW_KEY_R && action == GLFW_PRESS)
+    {
+      ctrl->reseed = true;
+    }
+
+    if (key == GLFW_KEY_O && action == GLFW_PRESS)
+    {
+      ctrl->census = true;
+    }
+
+    if (key == GLFW_KEY_LEFT && action != GLFW_RELEASE)
+    {
+      ctrl->scrub = -1;
+    }
+
+    if (key == GLFW_KEY_RIGHT && action != GLFW_RELEASE)
+    {
+      ctrl->scrub = 1;
+    }
+
+    if (key == GLFW_KEY_D && action == GLFW_PRESS)
+    {
+      ctrl->diff = true;
+    }
+
+    if (key == GLFW_KEY_KP_ADD)
+    {
+      ctrl->fpsOffset += 1;
+      if (ctrl->fpsOffset + FPS == 0 || ctrl->fpsOffset == FPS)
+      {
+        ctrl->fpsOffset += 1;
+      }
+    }
+
+    if (key == GLFW_KEY_KP_SUBTRACT)
+    {
+      ctrl->fpsOffset -= 1;
+      if (ctrl->fpsOffset + FPS == 0 || ctrl->fpsOffset == FPS)
+      {
+        ctrl->fpsOffset -= 1;
+      }
+    }
+    std::cout << ctrl->fpsOffset.load() << std::endl;
+  };
+  glfwSetKeyCallback(window, onKeyPressed);
+
+  BoardReadback readback;
+  result = readback.Create(physicalDevice, device, vkCmdPushDescriptorSetKHR, settings.imageWidth, settings.imageHeight, READBACK_SLOTS);
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not create board readback: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
+  }
+
+  BoardPainter painter;
+  result = painter.Create(physicalDevice, device, vkCmdPushDescriptorSetKHR, PAINT_SLOTS);
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not create board painter: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
+  }
+
+  // exports read the boards back through a ring of their own, so history captures never take their slots
+  std::unique_ptr<BoardExporter> exporter;
+  BoardReadback exportReadback;
+  if (!settings.exportPath.empty())
+  {
+    exporter = std::make_unique<BoardExporter>(settings.exportPath, settings.exportFormat, uint32_t(FPS));
+
+    result = exportReadback.Create(physicalDevice, device, vkCmdPushDescriptorSetKHR, settings.imageWidth, settings.imageHeight, EXPORT_SLOTS);
+    if (result != VK_SUCCESS)
+    {
+      std::cout << "could not create export readback: VkResult = " << VkResultToString(result) << std::endl;
+      GETOUT(1);
+    }
+  }
+
+  GenerationHistory history(size_t(settings.historyBudget) * 1024 * 1024, settings.keyframeInterval);
+
+  // the board generation of timeline generation g is (g - seedGeneration) * generationsPerStep + seedBase
+  uint64_t seedBase = 0;
+
+  auto boardGeneration = [&](uint64_t generation) -> uint64_t
+  {
+    return (generation - seedGeneration) * generationsPerStep + seedBase;
+  };
+
+  auto captureGeneration = [&](uint64_t generation)
+  {
+    if (settings.backend == Backend::Cpu)
+    {
+      history.Capture(boardGeneration(generation), cpuBoard());
+      if (exporter)
+      {
+        exporter->Write(boardGeneration(generation), cpuBoard());
+      }
+      return;
+    }
+
+    // captures are dropped rather than waited for when all readback slots are busy
+    bool accepted;
+    SemaphoreSubmit wait = { scheduler.GenerationTimeline(), generation, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+    readback.Request(computeQueue, boardImages[scheduler.Slot(generation)], wait, boardGeneration(generation), &accepted);
+
+    // steps wait for a free export slot, only seeds and edits may find none
+    if (exporter)
+    {
+      exportReadback.Request(computeQueue, boardImages[scheduler.Slot(generation)], wait, boardGeneration(generation), &accepted);
+    }
+  };
+
+  auto collectCaptures = [&]()
+  {
+    readback.Collect([&history](uint64_t generation, PackedBoard&& board)
+    {
+      PROFILE_COUNTER("cells alive", CountCells(board));
+      history.Capture(generation, std::move(board));
+    });
+
+    if (exporter)
+    {
+      exportReadback.Collect([&exporter](uint64_t generation, PackedBoard&& board)
+      {
+        exporter->Write(generation, std::move(board));
+      });
+    }
+  };
+
+  // the exporter slows the simulation down when the disk can't keep up, frames go on regardless
+  auto canExport = [&]() -> bool
+  {
+    return !exporter || exporter->Failed() || (exporter->Ready() && (settings.backend == Backend::Cpu || exportReadback.CanRequest()));
+  };
+
+  auto uploadSeed = [&](const PackedBoard& board, uint64_t base) -> bool
+  {
+    cpuEngine.SetBoard(board);
+    if (ltlEngine)
+    {
+      ltlEngine->SetBoard(board);
+    }
+    if (generationsEngine)
+    {
+      generationsEngine->SetBoard(board);
+    }
+
+    // the captures still in flight belong to the old board, they are handed over before it is replaced
+    {
+      std::lock_guard<std::mutex> lock(QueueMutex(computeQueue));
+      vkQueueWaitIdle(computeQueue);
+    }
+    collectCaptures();
+
+    std::vector<SemaphoreSubmit> waits;
+    uint64_t generation = scheduler.BeginGeneration(&waits, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    if (uploader.Upload(computeQueue, board, boardImages[scheduler.Slot(generation)], waits, scheduler.EndGeneration(generation)) != VK_SUCCESS)
+    {
+      return false;
+    }
+
+    seedGeneration = generation;
+    seedBase = base;
+    return true;
+  };
+
+  auto paintGeneration = [&](const std::vector<CellEdit>& edits) -> VkResult
+  {
+    if (settings.backend == Backend::Cpu)
+    {
+      for (const auto& edit : edits)
+      {
+        cpuEngine.SetCell(edit.x, edit.y, edit.alive != 0);
+        if (ltlEngine)
+        {
+          ltlEngine->SetCell(edit.x, edit.y, edit.alive != 0);
+        }
+        if (generationsEngine)
+        {
+          generationsEngine->SetCell(edit.x, edit.y, edit.alive != 0);
+        }
+      }
+    }
+
+    std::vector<SemaphoreSubmit> waits;
+    uint64_t generation = scheduler.BeginGeneration(&waits, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkResult result = painter.Apply(computeQueue, boardImages[scheduler.Slot(generation - 1)], boardImages[scheduler.Slot(generation)], edits, waits, scheduler.EndGeneration(generation));
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    // the edited board becomes a new seed with the board generation it was painted on, like a restored one
+    seedBase = boardGeneration(generation - 1);
+    seedGeneration = generation;
+    return VK_SUCCESS;
+  };
+
+  captureGeneration(seedGeneration);
+
+  // the simulation runs on its own thread, it steps as fast as it is asked to and never waits for a frame;
+  // the render thread picks up the newest complete generation and never waits for a step
+  TripleBuffer<uint64_t> presentMailbox;
+  std::atomic<bool> running(true);
+
+  // painted cells are handed to the simulation once per frame, guarded by paintMutex
+  std::vector<CellEdit> paintBatch;
+  uint64_t paintRequested = 0;
+  uint64_t paintApplied = 0;
+  std::mutex paintMutex;
+  std::condition_variable paintCondition;
+
+  auto simulate = [&]()
+  {
+    PROFILE_THREAD("simulation");
+
+    uint64_t published = 0;
+    auto start = std::chrono::system_clock::now();
+
+    while (running)
+    {
+      collectCaptures();
+      PROFILE_GPU_COLLECT(computeProfiler);
+
+      uint64_t completed = std::max(scheduler.CompletedGeneration(), published);
+      if (completed != published)
+      {
+        presentMailbox.Back() = completed;
+        presentMailbox.Publish();
+        published = completed;
+      }
+
+      // an edit takes a generation of its own, so it is bound by the run ahead like a step
+      std::vector<CellEdit> edits;
+      uint64_t paintRequest;
+      {
+        std::lock_guard<std::mutex> lock(paintMutex);
+        if (scheduler.CanRunAhead())
+        {
+          edits.swap(paintBatch);
+        }
+        paintRequest = paintRequested;
+      }
+
+      if (!edits.empty())
+      {
+        VkResult paintResult = paintGeneration(edits);
+        if (paintResult != VK_SUCCESS)
+        {
+          std::cout << "could not submit painted cells: VkResult = " << VkResultToString(paintResult) << std::endl;
+          break;
+        }
+
+        captureGeneration(seedGeneration);
+
+        // not complete yet, but cheap enough that the frame waiting for it on the GPU still shows the edit right away
+        presentMailbox.Back() = seedGeneration;
+        presentMailbox.Publish();
+        published = seedGeneration;
+
+        {
+          std::lock_guard<std::mutex> lock(paintMutex);
+          paintApplied = paintRequest;
+        }
+        paintCondition.notify_one();
+      }
+
+      if (control.reseed.exchange(false))
+      {
+        if (!uploadSeed(seedBoard, 0))
+        {
+          std::cout << "could not render initial image" << std::endl;
+          break;
+        }
+
+        history.Clear();
+        captureGeneration(seedGeneration);
+      }
+
+      int32_t scrub = control.scrub.exchange(0);
+      if (scrub != 0)
+      {
+        uint64_t current = boardGeneration(scheduler.SubmittedGeneration());
+        uint64_t target;
+        PackedBoard board;
+
+        bool found = scrub < 0 ? history.Previous(current, &target) : history.Next(current, &target);
+        if (found && history.Reconstruct(target, &board))
+        {
+          // the restored board becomes a new seed, stepping on from it starts a new branch of the history
+          control.paused = true;
+
+          if (!uploadSeed(board, target))
+          {
+            std::cout << "could not restore generation " << target << std::endl;
+            break;
+          }
+
+          std::cout << "generation " << target << " (" << history.Count() << " generations in " << history.Bytes() / 1024 << " KiB of history)" << std::endl;
+        }
+      }
+
+      if (control.diff.exchange(false))
+      {
+        uint64_t current = boardGeneration(scheduler.SubmittedGeneration());
+        uint64_t previous;
+        PackedBoard a, b;
+
+        if (history.Previous(current + 1, &current) && history.Previous(current, &previous) &&
+          history.Reconstruct(previous, &a) && history.Reconstruct(current, &b))
+        {
+          std::cout << "generation " << previous << " -> " << current << ": " << CountCells(DiffBoards(a, b)) << " cells changed, " << CountCells(b) << " alive" << std::endl;
+        }
+      }
+
+      if (control.checkpoint.exchange(false))
+      {
+        // the readback waits on the GPU for exactly this generation, even if it is still in flight
+        uint64_t generation = scheduler.SubmittedGeneration();
+
+        std::vector<uint32_t> texels;
+        if (!ReadbackImage(physicalDevice, device, transferQueue, boardImages[scheduler.Slot(generation)], scheduler.GenerationTimeline(), generation, &texels) ||
+          !WriteCheckpoint("checkpoint_" + std::to_string(boardGeneration(generation)) + ".txt", texels, settings))
+        {
+          std::cout << "could not write checkpoint" << std::endl;
+        }
+      }
+
+      if (control.census.exchange(false))
+      {
+        // read back like a checkpoint, the generation shown may lag behind by the run ahead
+        uint64_t generation = scheduler.SubmittedGeneration();
+
+        std::vector<uint32_t> texels;
+        if (ReadbackImage(physicalDevice, device, transferQueue, boardImages[scheduler.Slot(generation)], scheduler.GenerationTimeline(), generation, &texels))
+        {
+          PrintCensus(boardGeneration(generation), TakeCensus(PackTexels(texels.data(), settings.imageWidth, settings.imageHeight)));
+        }
+        else
+        {
+          std::cout << "could not read back the board for the census" << std::endl;
+        }
+      }
+
+      auto current = std::chrono::system_clock::now();
+      auto d = current - start;
+      auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(d);
+      auto stepInterval = std::chrono::milliseconds(1000 / (FPS + control.fpsOffset));
+      bool paused = control.paused;
+
+      // catch up on every step that is due, but never further than the run ahead bound;
+      // in throughput mode every step is due and only the GPU bounds them
+      auto due = paused ? 0 : diff / stepInterval;
+      if (settings.throughput && !paused)
+      {
+        due = std::numeric_limits<decltype(due)>::max();
+      }
+      VkResult stepResult = VK_SUCCESS;
+      while (due > 0 && scheduler.CanRunAhead() && canExport() && stepResult == VK_SUCCESS)
+      {
+        stepResult = stepGeneration();
+        if (stepResult == VK_SUCCESS)
+        {
+          captureGeneration(scheduler.SubmittedGeneration());
+        }
+
+        start += stepInterval;
+        due--;
+      }
+
+      PROFILE_COUNTER("generations ahead", scheduler.SubmittedGeneration() - scheduler.PresentedGeneration());
+
+      if (stepResult != VK_SUCCESS)
+      {
+        std::cout << "could not submit simulation step: VkResult = " << VkResultToString(stepResult) << std::endl;
+        break;
+      }
+
+      if (due > 0 || paused)
+      {
+        // presentation is too slow or the simulation is paused, drop the steps instead of building up a backlog
+        start = current;
+      }
+
+      if (settings.throughput && !paused && !scheduler.CanRunAhead())
+      {
+        // woken by the GPU rather than a timer, so the steps keep up with it
+        scheduler.WaitForGeneration(scheduler.SubmittedGeneration() + 1 - std::max(settings.runAhead, 1u), 1000000);
+      }
+      else
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+    running = false;
+  };
+
+  std::thread simulation(simulate);
+
+  PROFILE_THREAD("render");
+
+  uint64_t presentGeneration = scheduler.PresentedGeneration();
+  while (running && !glfwWindowShouldClose(window))
+  {
+    PROFILE_SCOPE("frame");
+    PROFILE_GPU_COLLECT(graphicsProfiler);
+
+    {
+      PROFILE_SCOPE("poll events");
+      glfwPollEvents();
+    }
+
+    if (!control.strokes.empty())
+    {
+      // one batch per frame, the frame waits briefly for the simulation to take it so it already shows the edits
+      std::unique_lock<std::mutex> lock(paintMutex);
+      paintBatch.insert(paintBatch.end(), control.strokes.begin(), control.strokes.end());
+      control.strokes.clear();
+
+      uint64_t request = ++paintRequested;
+      PROFILE_SCOPE("paint wait");
+      paintCondition.wait_for(lock, std::chrono::milliseconds(8), [&]() { return paintApplied >= request; });
+    }
+
+    // present the newest generation that is already complete, so a frame never waits for a step
+    if (presentMailbox.Update())
+    {
+      presentGeneration = presentMailbox.Front();
+    }
+
+    uint32_t frameIndex;
+    {
+      PROFILE_SCOPE("frame wait");
+      frameIndex = scheduler.BeginFrame();
+    }
+    VkCommandBuffer command = commands[frameIndex];
+
+    // write ubo, the present pass of the other frame in flight may still read its own
+    ubo.mat = camera.WorldToScreenMatrix();
+
+    void* uboData;
+    vkMapMemory(device, uboBuffers[frameIndex].memory, 0, sizeof(Ubo), 0, &uboData);
+    memcpy(uboData, &ubo, sizeof(Ubo));
+    vkUnmapMemory(device, uboBuffers[frameIndex].memory);
+    uboBufferInfo.buffer = uboBuffers[frameIndex].buffer;
+
+    vkResetCommandBuffer(command, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+
+    uint32_t imageIndex;
+    {
+      PROFILE_SCOPE("acquire");
+      result = vkAcquireNextImageKHR(device, swapchain.swapchain, std::numeric_limits<uint64_t>::max(), scheduler.ImageAvailable(frameIndex), VK_NULL_HANDLE, &imageIndex);
+    }
+
+    // nothing was acquired and nothing signaled, the frame starts over with the new swapchain
+    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    {
+      control.resized = false;
+      result = recreateSwapchain();
+      if (result != VK_SUCCESS)
+      {
+        std::cout << "could not recreate swapchain: VkResult = " << VkResultToString(result) << std::endl;
+        break;
+      }
       continue;
     }
-    VkFramebuffer frontbuffer = std::get<VkFramebuffer>(framebufferCreation);
-    VkFramebuffer backbuffer = VK_NULL_HANDLE;
 
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+    {
+      std::cout << "could not acquire swapchain image: VkResult = " << VkResultToString(result) << std::endl;
+      break;
+    }
+
+    // a step lapping the slot ring may already have overwritten the generation from the mailbox, then the newest complete one is shown
+    while (!scheduler.PinGeneration(presentGeneration))
+    {
+      presentGeneration = scheduler.CompletedGeneration();
+    }
+
+    presentImageDescriptor.imageView = boardImages[scheduler.Slot(presentGeneration)].view;
+
+    VkDeviceSize offsets[1] = { 0 };
+    BeginCommandBuffer(command, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    PROFILE_GPU_BEGIN(frameQuery, graphicsProfiler, command, "present pass", presentGeneration);
+
+    std::array<VkWriteDescriptorSet, 3> writeDescriptorSets = {};
+    writeDescriptorSets[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSets[0].dstSet = 0;
+    writeDescriptorSets[0].dstBinding = 0;
+    writeDescriptorSets[0].descriptorCount = 1;
+    writeDescriptorSets[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writeDescriptorSets[0].pBufferInfo = &uboBufferInfo;
+
+    writeDescriptorSets[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSets[1].dstSet = 0;
+    writeDescriptorSets[1].dstBinding = 1;
+    writeDescriptorSets[1].descriptorCount = 1;
+    writeDescriptorSets[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeDescriptorSets[1].pImageInfo = &presentImageDescriptor;
+
+    writeDescriptorSets[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSets[2].dstSet = 0;
+    writeDescriptorSets[2].dstBinding = 2;
+    writeDescriptorSets[2].descriptorCount = 1;
+    writeDescriptorSets[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeDescriptorSets[2].pImageInfo = &paletteDescriptor;
+
+    BeginRenderPass(command, renderPass, framebuffers[imageIndex], swapchain.extent, { { 0.12f, 0.12f, 0.12f, 1.0f } });
+    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdPushDescriptorSetKHR(command, VK_PIPELINE_BIND_POINT_GRAPHICS, presentPipelineLayout, 0, uint32_t(writeDescriptorSets.size()), writeDescriptorSets.data());
+    vkCmdPushConstants(command, presentPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(presentHeat), &presentHeat);
+
+    offsets[0] = { sizeof(Vertex) * 4 }; // skip first 4 vertices
+    vkCmdBindVertexBuffers(command, 0, 1, &deviceBuffer.buffer, offsets);
+    vkCmdBindIndexBuffer(command, deviceBuffer.buffer, vertexSize, VK_INDEX_TYPE_UINT16);
+
+    vkCmdDrawIndexed(command, 6, 1, 0, 0, 0);
+
+    vkCmdEndRenderPass(command);
+
+    PROFILE_GPU_END(frameQuery, graphicsProfiler, command);
+    vkEndCommandBuffer(command);
+
+    result = QueueSubmit(graphicsQueue, command, scheduler.FrameWaits(frameIndex, presentGeneration), scheduler.FrameSignals(frameIndex));
+    if (result != VK_SUCCESS)
+    {
+      std::cout << "could not submit frame: VkResult = " << VkResultToString(result) << std::endl;
+      break;
+    }
+
+    scheduler.EndFrame(presentGeneration);
+
+    VkSemaphore renderFinished = scheduler.RenderFinished(frameIndex);
+
+    VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &renderFinished;
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &swapchain.swapchain;
+    presentInfo.pImageIndices = &imageIndex;
+
+    {
+      PROFILE_SCOPE("present");
+      std::lock_guard<std::mutex> lock(QueueMutex(presentationQueue));
+      result = vkQueuePresentKHR(presentationQueue, &presentInfo);
+    }
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || control.resized)
+    {
+      control.resized = false;
+      result = recreateSwapchain();
+    }
+
+    if (result != VK_SUCCESS)
+    {
+      std::cout << "could not present: VkResult = " << VkResultToString(result) << std::endl;
+      break;
+    }
+  }
+
+  running = false;
+  simulation.join();
+
+  vkDeviceWaitIdle(device);
+
+  // hands the last boards to the exporter, which writes them before it goes away
+  collectCaptures();
+  exporter.reset();
+
+  destroyPresentTargets();
+
+  readback.Destroy();
+  if (!settings.exportPath.empty())
+  {
+    exportReadback.Destroy();
+  }
+  painter.Destroy();
+  uploader.Destroy();
+  if (!life)
+  {
+    ltlKernel.Destroy();
+  }
+  scheduler.Destroy();
+#ifdef GOL_PROFILE
+  computeProfiler.Destroy();
+  graphicsProfiler.Destroy();
+#endif
+  vkDestroyCommandPool(device, computeCommandPool, nullptr);
+
+  FreeBuffer(device, hostBuffer);
+  FreeBuffer(device, deviceBuffer);
+  FreeImage(device, palette);
+  for (auto& uboBuffer : uboBuffers)
+  {
+    FreeBuffer(device, uboBuffer);
+  }
+  vkDestroySampler(device, paletteSampler, nullptr);
+
+  vkDestroySwapchainKHR(device, swapchain.swapchain, nullptr);
+  vkDestroyDevice(device, nullptr);
+  vkDestroySurfaceKHR(instance, surface, nullptr);
+  vkDestroyInstance(instance, nullptr);
+
+  glfwDestroyWindow(window);
+  glfwTerminate();
+
+  PROFILE_WRITE();
+  GETOUT(0)
+}
+
+bool UploadBuffer(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue graphicsQueue, const Buffer& hostBuffer, const Buffer& deviceBuffer)
+{
+  VkCommandPool commandPool;
+  VkCommandBuffer cmdBuffer;
+  VkFence fence;
+
+  auto commandPoolCreation = CreateCommandPool(device, physicalDevice.graphicsQueueIndex);
+  CHECK_RESULT_BOOL(commandPoolCreation);
+  commandPool = std::get<VkCommandPool>(commandPoolCreation);
+
+  auto result = AllocateCommandBuffer(device, commandPool, 1, &cmdBuffer);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  result = BeginCommandBuffer(cmdBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  // copy quad data from host to device
+  VkBufferCopy bufferRegion = {};
+  bufferRegion.dstOffset = 0;
+  bufferRegion.srcOffset = 0;
+  bufferRegion.size = deviceBuffer.size;
+
+  vkCmdCopyBuffer(cmdBuffer, hostBuffer.buffer, deviceBuffer.buffer, 1, &bufferRegion);
+
+  result = vkEndCommandBuffer(cmdBuffer);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  auto fenceCreation = CreateFence(device);
+  CHECK_RESULT_BOOL(fenceCreation);
+  fence = std::get<VkFence>(fenceCreation);
+
+  result = QueueSubmit(graphicsQueue, cmdBuffer, {}, {}, fence);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  result = vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  vkDestroyFence(device, fence, nullptr);
+  vkFreeCommandBuffers(device, commandPool, 1, &cmdBuffer);
+  vkDestroyCommandPool(device, commandPool, nullptr);
+  return true;
+}
+
+bool UploadPalette(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue graphicsQueue, const Image2D& palette)
+{
+  VkCommandPool commandPool;
+  VkCommandBuffer cmdBuffer;
+  VkFence fence;
+
+  // newborn cells white hot, cooling down over yellow, orange and red to a dim blue at 255 generations
+  const std::array<std::pair<float, glm::vec3>, 5> stops =
+  { {
+    { 0.0f, glm::vec3(1.0f, 1.0f, 0.9f) },
+    { 0.03f, glm::vec3(1.0f, 0.85f, 0.2f) },
+    { 0.15f, glm::vec3(0.95f, 0.3f, 0.05f) },
+    { 0.5f, glm::vec3(0.5f, 0.05f, 0.45f) },
+    { 1.0f, glm::vec3(0.1f, 0.15f, 0.55f) }
+  } };
+
+  std::vector<uint32_t> texels(palette.width);
+  for (uint32_t i = 0; i < palette.width; i++)
+  {
+    float t = float(i) / float(palette.width - 1);
+    size_t stop = 1;
+    while (stop + 1 < stops.size() && stops[stop].first < t)
+    {
+      stop++;
+    }
+
+    glm::vec3 color = glm::mix(stops[stop - 1].second, stops[stop].second, (t - stops[stop - 1].first) / (stops[stop].first - stops[stop - 1].first));
+    texels[i] = uint32_t(color.r * 255.0f + 0.5f) | uint32_t(color.g * 255.0f + 0.5f) << 8 | uint32_t(color.b * 255.0f + 0.5f) << 16 | 0xFF000000u;
+  }
+
+  VkDeviceSize size = texels.size() * sizeof(uint32_t);
+  auto stagingCreation = CreateBuffer(physicalDevice, device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  CHECK_RESULT_BOOL(stagingCreation);
+  Buffer staging = std::get<Buffer>(stagingCreation);
+
+  void* data;
+  vkMapMemory(device, staging.memory, 0, size, 0, &data);
+  memcpy(data, texels.data(), size);
+  vkUnmapMemory(device, staging.memory);
+
+  auto commandPoolCreation = CreateCommandPool(device, physicalDevice.graphicsQueueIndex);
+  CHECK_RESULT_BOOL(commandPoolCreation);
+  commandPool = std::get<VkCommandPool>(commandPoolCreation);
+
+  auto result = AllocateCommandBuffer(device, commandPool, 1, &cmdBuffer);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  result = BeginCommandBuffer(cmdBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  TransitionImageLayout(cmdBuffer, palette.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  VkBufferImageCopy region = {};
+  region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+  region.imageExtent = { palette.width, palette.height, 1 };
+  vkCmdCopyBufferToImage(cmdBuffer, staging.buffer, palette.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  // never written again, the frames only sample it
+  TransitionImageLayout(cmdBuffer, palette.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+  result = vkEndCommandBuffer(cmdBuffer);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  auto fenceCreation = CreateFence(device);
+  CHECK_RESULT_BOOL(fenceCreation);
+  fence = std::get<VkFence>(fenceCreation);
+
+  result = QueueSubmit(graphicsQueue, cmdBuffer, {}, {}, fence);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  result = vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  vkDestroyFence(device, fence, nullptr);
+  vkFreeCommandBuffers(device, commandPool, 1, &cmdBuffer);
+  vkDestroyCommandPool(device, commandPool, nullptr);
+  FreeBuffer(device, staging);
+  return true;
+}
+
+bool ReadbackImage(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue transferQueue, const Image2D& image, VkSemaphore timeline, uint64_t waitValue, std::vector<uint32_t>* texels)
+{
+  VkCommandPool commandPool;
+  VkCommandBuffer cmdBuffer;
+  VkFence fence;
+
+  VkDeviceSize readbackSize = sizeof(uint32_t) * image.width * image.height;
+  auto readbackBufferCreation = CreateBuffer(physicalDevice, device, readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  CHECK_RESULT_BOOL(readbackBufferCreation);
+  Buffer readbackBuffer = std::get<Buffer>(readbackBufferCreation);
+
+  auto commandPoolCreation = CreateCommandPool(device, physicalDevice.transferQueueIndex);
+  CHECK_RESULT_BOOL(commandPoolCreation);
+  commandPool = std::get<VkCommandPool>(commandPoolCreation);
+
+  auto result = AllocateCommandBuffer(device, commandPool, 1, &cmdBuffer);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  result = BeginCommandBuffer(cmdBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  VkBufferImageCopy bufferImageRegion = {};
+  bufferImageRegion.bufferOffset = 0;
+  bufferImageRegion.bufferRowLength = 0;
+  bufferImageRegion.bufferImageHeight = 0;
+  bufferImageRegion.imageOffset = { 0, 0, 0 };
+  bufferImageRegion.imageExtent = { image.width, image.height, 1 };
+  bufferImageRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  bufferImageRegion.imageSubresource.mipLevel = 0;
+  bufferImageRegion.imageSubresource.baseArrayLayer = 0;
+  bufferImageRegion.imageSubresource.layerCount = 1;
+
+  vkCmdCopyImageToBuffer(cmdBuffer, image.image, VK_IMAGE_LAYOUT_GENERAL, readbackBuffer.buffer, 1, &bufferImageRegion);
+
+  result = vkEndCommandBuffer(cmdBuffer);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  auto fenceCreation = CreateFence(device);
+  CHECK_RESULT_BOOL(fenceCreation);
+  fence = std::get<VkFence>(fenceCreation);
+
+  // waits on the GPU for the generation to be written, not on the host
+  result = QueueSubmit(transferQueue, cmdBuffer, { { timeline, waitValue, VK_PIPELINE_STAGE_TRANSFER_BIT } }, {}, fence);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  result = vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  texels->resize(image.width * image.height);
+
+  void* data;
+  vkMapMemory(device, readbackBuffer.memory, 0, readbackSize, 0, &data);
+  memcpy(texels->data(), data, readbackSize);
+  vkUnmapMemory(device, readbackBuffer.memory);
+
+  vkDestroyFence(device, fence, nullptr);
+  vkFreeCommandBuffers(device, commandPool, 1, &cmdBuffer);
+  vkDestroyCommandPool(device, commandPool, nullptr);
+  FreeBuffer(device, readbackBuffer);
+  return true;
+}
+
+bool WriteCheckpoint(const std::string& fileName, const std::vector<uint32_t>& texels, const Settings& settings)
+{
+  // same format as --UseFile, so a checkpoint can be used as a seed again
+  std::ofstream f(fileName);
+  if (!f.is_open())
+  {
+    return false;
+  }
+
+  for (uint32_t y = 0; y < settings.imageHeight; y++)
+  {
+    for (uint32_t x = 0; x < settings.imageWidth; x++)
+    {
+      // alpha lives in the highest byte of a R8G8B8A8 texel
+      if ((texels[x + y * settings.imageWidth] >> 24) > 0x40)
+      {
+        f << x << "," << y << "\n";
+      }
+    }
+  }
+
+  return !f.bad();
+}
+
+bool WriteCheckpoint(const std::string& fileName, const PackedBoard& board)
+{
+  // the same format straight from the words, a board too large for texels still fits on disk
+  std::ofstream f(fileName);
+  if (!f.is_open())
+  {
+    return false;
+  }
+
+  for (uint32_t y = 0; y < board.height; y++)
+  {
+    for (uint32_t w = 0; w < board.wordsPerRow; w++)
+    {
+      uint64_t word = board.words[size_t(y) * board.wordsPerRow + w];
+      while (word != 0)
+      {
+        f << w * 64 + LowestSetBit(word) << "," << y << "\n";
+        word &= word - 1;
+      }
+    }
+  }
+
+  return !f.bad();
+}
+
+void PrintCensus(uint64_t generation, const std::vector<CensusEntry>& census)
+{
+  uint64_t objects = 0;
+  for (const auto& entry : census)
+  {
+    objects += entry.count;
+  }
+
+  std::cout << "generation " << generation << ": " << objects << " objects of " << census.size() << " kinds" << std::endl;
+  for (const auto& entry : census)
+  {
+    // unknown objects by their hash, so the same one can be found again in another census
+    std::cout << "  " << entry.count << " x " << entry.name;
+    if (entry.name == "unknown")
+    {
+      std::cout << " " << std::hex << entry.hash << std::dec;
+    }
+    std::cout << " (" << entry.cells << " cells)" << std::endl;
+  }
+}
+
+bool BenchmarkKernel(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue computeQueue, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, VkPipeline pipeline, VkPipelineLayout layout, VkSampler sampler, const Image2D& a, const Image2D& b, SemaphoreSubmit seedWritten, Kernel kernel, StepPush push, uint32_t generations, double* generationsPerSecond)
+{
+  VkCommandPool commandPool;
+  VkCommandBuffer cmdBuffer;
+  VkFence fence;
+
+  auto commandPoolCreation = CreateCommandPool(device, physicalDevice.computeQueueIndex);
+  CHECK_RESULT_BOOL(commandPoolCreation);
+  commandPool = std::get<VkCommandPool>(commandPoolCreation);
+
+  auto result = AllocateCommandBuffer(device, commandPool, 1, &cmdBuffer);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  result = BeginCommandBuffer(cmdBuffer, 0);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  // the second image never held a generation yet, and whatever it holds gets overwritten by the first dispatch
+  TransitionImageLayout(cmdBuffer, b.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+  // ping pong between the two images, every step waits for the writes of the previous one
+  VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+  // the last dispatch of the multi kernel only takes the generations left, so every kernel steps exactly as many
+  uint32_t dispatches = (generations + push.generations - 1) / push.generations;
+  for (uint32_t i = 0; i < dispatches; i++)
+  {
+    StepPush dispatchPush = push;
+    dispatchPush.generations = std::min(push.generations, generations - i * push.generations);
+    uint32_t tile = KernelTile(kernel, dispatchPush.generations);
+
+    const Image2D& src = i % 2 == 0 ? a : b;
+    const Image2D& dst = i % 2 == 0 ? b : a;
+
+    std::vector<VkDescriptorImageInfo> samplerInfos = { { sampler, src.view, VK_IMAGE_LAYOUT_GENERAL } };
+    std::vector<VkDescriptorImageInfo> storageInfos = { { VK_NULL_HANDLE, dst.view, VK_IMAGE_LAYOUT_GENERAL } };
+
+    std::array<VkWriteDescriptorSet, 2> writeDescriptorSets = {};
+    writeDescriptorSets[0] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, {}, samplerInfos);
+    writeDescriptorSets[1] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, {}, storageInfos);
+
+    vkCmdPushDescriptorSetKHR(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, uint32_t(writeDescriptorSets.size()), writeDescriptorSets.data());
+    vkCmdPushConstants(cmdBuffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(dispatchPush), &dispatchPush);
+    vkCmdDispatch(cmdBuffer, (a.width + tile - 1) / tile, (a.height + tile - 1) / tile, 1);
+
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+  }
+
+  result = vkEndCommandBuffer(cmdBuffer);
+  if (result != VK_SUCCESS)
+  {
+    return false;
+  }
+
+  auto fenceCreation = CreateFence(device);
+  CHECK_RESULT_BOOL(fenceCreation);
+  fence = std::get<VkFence>(fenceCreation);
 
-    VkDeviceSize offsets[1] = { 0 };
-    BeginCommandBuffer(command, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  // the first run warms up caches and clocks, only the second one is timed
+  std::chrono::duration<double> elapsed;
+  for (uint32_t run = 0; run < 2; run++)
+  {
+    auto start = std::chrono::steady_clock::now();
 
-    if (diff.count() >= (1000 / (FPS + control.fpsOffset)))
+    // the seed may still be uploading when the first run is submitted
+    result = QueueSubmit(computeQueue, cmdBuffer, { seedWritten }, {}, fence);
+    if (result != VK_SUCCESS)
     {
-      // swap infos
-      Image2D* temp = images[0];
-      images[0] = images[1];
-      images[1] = temp;
+      return false;
+    }
 
-      descriptorImageInfos[0].imageView = images[0]->view;
-      presentImageDescriptor.imageView = images[1]->view;
+    result = vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    if (result != VK_SUCCESS)
+    {
+      return false;
+    }
 
-      auto framebufferCreation = CreateFramebuffer(device, renderPassGoL, settings.imageWidth, settings.imageHeight, { images[1]->view });
-      if (std::holds_alternative<VkResult>(framebufferCreation))
-      {
-        // bad things happened
-        continue;
-      }
-      backbuffer = std::get<VkFramebuffer>(framebufferCreation);
+    elapsed = std::chrono::steady_clock::now() - start;
+    vkResetFences(device, 1, &fence);
+  }
 
-      auto writeDescriptorSet = CreateWriteDescriptorSet(VK_NULL_HANDLE, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, {}, descriptorImageInfos);
+  *generationsPerSecond = generations / elapsed.count();
 
-      BeginRenderPass(command, renderPassGoL, backbuffer, { settings.imageWidth, settings.imageHeight }, { { 0.0f, 0.0f, 0.0f, 1.0f } });
+  vkDestroyFence(device, fence, nullptr);
+  vkFreeCommandBuffers(device, commandPool, 1, &cmdBuffer);
+  vkDestroyCommandPool(device, commandPool, nullptr);
+  return true;
+}
 
-      vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineGoL);
-      vkCmdPushDescriptorSetKHR(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &writeDescriptorSet);
+int RunStrips(const Settings& settings)
+{
+  // headless, the window and its device are not needed to step strips
+  if (!CheckVulkanVersion(VK_API_VERSION_1_2))
+  {
+    std::cout << "Vulkan Version is not high enough" << std::endl;
+    GETOUT(1)
+  }
 
-      vkCmdBindVertexBuffers(command, 0, 1, &deviceBuffer.buffer, offsets);
-      vkCmdBindIndexBuffer(command, deviceBuffer.buffer, vertexSize, VK_INDEX_TYPE_UINT16);
+  auto layers = CheckInstanceLayers({ "VK_LAYER_LUNARG_standard_validation" });
+  CHECK_RESULT(layers, "could not get layers");
 
-      vkCmdDrawIndexed(command, 6, 1, 0, 0, 0);
+  auto creation = CreateInstance("Game of Life", VK_MAKE_VERSION(0, 1, 0), VK_API_VERSION_1_2, std::get<std::vector<const char*>>(layers), {});
+  CHECK_RESULT(creation, "could not create instance");
+  VkInstance instance = std::get<VkInstance>(creation);
 
-      vkCmdEndRenderPass(command);
+  auto physicalDeviceSelection = GetComputePhysicalDevices(instance, { VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME });
+  CHECK_RESULT(physicalDeviceSelection, "could not enumerate physical devices");
 
-      start = std::chrono::system_clock::now();
-    }
+  auto physicalDevices = std::get<std::vector<PhysicalDevice>>(physicalDeviceSelection);
+  if (physicalDevices.empty())
+  {
+    std::cout << "no suitable device found" << std::endl;
+    GETOUT(1);
+  }
 
-    std::array<VkWriteDescriptorSet, 2> writeDescriptorSets = {};
-    writeDescriptorSets[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writeDescriptorSets[0].dstSet = 0;
-    writeDescriptorSets[0].dstBinding = 0;
-    writeDescriptorSets[0].descriptorCount = 1;
-    writeDescriptorSets[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    writeDescriptorSets[0].pBufferInfo = &uboBufferInfo;
+  // more strips than physical devices share them round robin, each with its own logical device
+  std::vector<ComputeContext> contexts;
+  for (uint32_t i = 0; i < settings.devices; i++)
+  {
+    auto contextCreation = CreateComputeContext(physicalDevices[i % physicalDevices.size()]);
+    CHECK_RESULT(contextCreation, "could not create compute context");
+    contexts.push_back(std::get<ComputeContext>(contextCreation));
+  }
 
-    writeDescriptorSets[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writeDescriptorSets[1].dstSet = 0;
-    writeDescriptorSets[1].dstBinding = 1;
-    writeDescriptorSets[1].descriptorCount = 1;
-    writeDescriptorSets[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    writeDescriptorSets[1].pImageInfo = &presentImageDescriptor;
+  StripEngine engine;
+  auto result = engine.Create(contexts, settings.imageWidth, settings.imageHeight, settings.topology);
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not create strips: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
+  }
 
-    BeginRenderPass(command, renderPass, frontbuffer, { settings.windowWidth, settings.windowHeight }, { { 0.12f, 0.12f, 0.12f, 1.0f } });
-    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-    vkCmdPushDescriptorSetKHR(command, VK_PIPELINE_BIND_POINT_GRAPHICS, presentPipelineLayout, 0, 2, writeDescriptorSets.data());
+  for (uint32_t i = 0; i < engine.StripCount(); i++)
+  {
+    std::cout << "strip " << i << ": " << engine.StripRows(i) << " rows on " << contexts[i].physicalDevice.properties.deviceName << std::endl;
+  }
 
-    offsets[0] = { sizeof(Vertex) * 4 }; // skip first 4 vertices
-    vkCmdBindVertexBuffers(command, 0, 1, &deviceBuffer.buffer, offsets);
-    vkCmdBindIndexBuffer(command, deviceBuffer.buffer, vertexSize, VK_INDEX_TYPE_UINT16);
+  result = engine.SetBoard(InitialBoard(settings));
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not upload the seed: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
+  }
 
-    vkCmdDrawIndexed(command, 6, 1, 0, 0, 0);
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t generation = 0; generation < settings.generations && result == VK_SUCCESS; generation++)
+  {
+    PROFILE_SCOPE("strips step");
+    result = engine.Step();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-    vkCmdEndRenderPass(command);
+  PackedBoard board;
+  if (result == VK_SUCCESS)
+  {
+    result = engine.GetBoard(&board);
+  }
 
-    vkEndCommandBuffer(command);
+  if (result != VK_SUCCESS)
+  {
+    std::cout << "could not step strips: VkResult = " << VkResultToString(result) << std::endl;
+    GETOUT(1);
+  }
+
+  std::cout << settings.generations << " generations: " << settings.generations / elapsed.count() << " generations/s, " << CountCells(board) << " cells alive" << std::endl;
+
+  if (!WriteCheckpoint("checkpoint_" + std::to_string(settings.generations) + ".txt", board))
+  {
+    std::cout << "could not write checkpoint" << std::endl;
+  }
 
-    VkSemaphore signalSemaphores[] = { renderFinishedSemaphore };
-    VkSemaphore waitSemaphores[] = { imageAvailableSemaphore };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+  if (settings.census)
+  {
+    PrintCensus(settings.generations, TakeCensus(board));
+  }
 
-    VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
-    submitInfo.pNext = nullptr;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &command;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
+  engine.Destroy();
+  for (auto& context : contexts)
+  {
+    DestroyComputeContext(context);
+  }
 
-    result = vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence);
+  vkDestroyInstance(instance, nullptr);
 
-    VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = &renderFinishedSemaphore;
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = &swapchain.swapchain;
-    presentInfo.pImageIndices = &imageIndex;
+  PROFILE_WRITE();
+  return 0;
+}
 
-    vkQueuePresentKHR(presentationQueue, &presentInfo);
+int RunBatch(const Settings& settings)
+{
+  std::vector<PackedBoard> boards;
+  boards.reserve(settings.batch);
+  for (uint32_t i = 0; i < settings.batch; i++)
+  {
+    Settings boardSettings = settings;
+    boardSettings.seed = settings.seed + i;
+    boards.push_back(InitialBoard(boardSettings));
+  }
 
-    vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
-    vkResetFences(device, 1, &fence);
+  std::vector<BatchStats> stats;
+  std::chrono::duration<double> elapsed;
+  std::string steppedOn;
 
-    vkDestroyFramebuffer(device, frontbuffer, nullptr);
+  if (settings.backend == Backend::Cpu)
+  {
+    LaneEngine engine(settings.imageWidth, settings.imageHeight, settings.batch, settings.topology);
+    for (uint32_t i = 0; i < settings.batch; i++)
+    {
+      engine.SetBoard(i, boards[i]);
+    }
+    boards.clear();
 
-    if (backbuffer != VK_NULL_HANDLE)
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t generation = 0; generation < settings.generations; generation++)
     {
-      vkDestroyFramebuffer(device, backbuffer, nullptr);
+      engine.Step();
     }
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    stats = engine.Stats();
+    steppedOn = "the cpu";
   }
+  else
+  {
+    // headless like the strips, but a single device steps every board
+    if (!CheckVulkanVersion(VK_API_VERSION_1_2))
+    {
+      std::cout << "Vulkan Version is not high enough" << std::endl;
+      GETOUT(1)
+    }
 
+    auto layers = CheckInstanceLayers({ "VK_LAYER_LUNARG_standard_validation" });
+    CHECK_RESULT(layers, "could not get layers");
 
+    auto creation = CreateInstance("Game of Life", VK_MAKE_VERSION(0, 1, 0), VK_API_VERSION_1_2, std::get<std::vector<const char*>>(layers), {});
+    CHECK_RESULT(creation, "could not create instance");
+    VkInstance instance = std::get<VkInstance>(creation);
 
-  FreeBuffer(device, hostBuffer);
-  FreeBuffer(device, deviceBuffer);
+    auto physicalDeviceSelection = GetComputePhysicalDevices(instance, { VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME });
+    CHECK_RESULT(physicalDeviceSelection, "could not enumerate physical devices");
+
+    auto physicalDevices = std::get<std::vector<PhysicalDevice>>(physicalDeviceSelection);
+    if (physicalDevices.empty())
+    {
+      std::cout << "no suitable device found" << std::endl;
+      GETOUT(1);
+    }
+
+    auto contextCreation = CreateComputeContext(physicalDevices[0]);
+    CHECK_RESULT(contextCreation, "could not create compute context");
+    ComputeContext context = std::get<ComputeContext>(contextCreation);
+
+    BatchEngine engine;
+    auto result = engine.Create(context, settings.imageWidth, settings.imageHeight, settings.batch, settings.topology);
+    if (result != VK_SUCCESS)
+    {
+      std::cout << "could not create the batch: VkResult = " << VkResultToString(result) << std::endl;
+      GETOUT(1);
+    }
 
-  for (auto& imageView : swapchain.imageViews)
+    result = engine.SetBoards(boards);
+    if (result != VK_SUCCESS)
+    {
+      std::cout << "could not upload the seeds: VkResult = " << VkResultToString(result) << std::endl;
+      GETOUT(1);
+    }
+    boards.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    result = engine.Step(settings.generations);
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    if (result != VK_SUCCESS)
+    {
+      std::cout << "could not step the batch: VkResult = " << VkResultToString(result) << std::endl;
+      GETOUT(1);
+    }
+
+    for (uint32_t i = 0; i < settings.batch; i++)
+    {
+      stats.push_back(engine.Stats(i));
+    }
+    steppedOn = context.physicalDevice.properties.deviceName;
+
+    engine.Destroy();
+    DestroyComputeContext(context);
+    vkDestroyInstance(instance, nullptr);
+  }
+
+  double cells = double(settings.imageWidth) * settings.imageHeight * settings.batch * settings.generations;
+  std::cout << settings.batch << " boards of " << settings.imageWidth << "x" << settings.imageHeight << " on " << steppedOn << ", "
+    << settings.generations << " generations: " << settings.generations / elapsed.count() << " generations/s, " << cells / elapsed.count() << " cells/s" << std::endl;
+
+  // settled boards only hold still lifes, oscillators and spaceships keep changing cells
+  uint32_t died = 0;
+  uint32_t settled = 0;
+  std::vector<uint32_t> order(settings.batch);
+  for (uint32_t i = 0; i < settings.batch; i++)
   {
-    vkDestroyImageView(device, imageView, nullptr);
+    died += stats[i].population == 0 ? 1 : 0;
+    settled += stats[i].population > 0 && stats[i].changed == 0 ? 1 : 0;
+    order[i] = i;
   }
 
-  vkDestroySwapchainKHR(device, swapchain.swapchain, nullptr);
-  vkDestroyDevice(device, nullptr);
-  vkDestroySurfaceKHR(instance, surface, nullptr);
-  vkDestroyInstance(instance, nullptr);
+  std::cout << died << " died out, " << settled << " settled, " << settings.batch - died - settled << " still changing" << std::endl;
 
-  glfwDestroyWindow(window);
-  glfwTerminate();
-  GETOUT(0)
+  uint32_t shown = std::min(settings.batch, 10u);
+  std::partial_sort(order.begin(), order.begin() + shown, order.end(), [&](uint32_t a, uint32_t b) { return stats[a].population > stats[b].population; });
+  for (uint32_t i = 0; i < shown; i++)
+  {
+    const BatchStats& board = stats[order[i]];
+    std::cout << "seed " << settings.seed + order[i] << ": " << board.population << " cells alive, " << board.changed << " changed in the last generation" << std::endl;
+  }
+
+  PROFILE_WRITE();
+  return 0;
 }
 
-bool RenderInitialImage(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue graphicsQueue, uint32_t* positions, uint32_t positionCount, const Image2D& image, const Buffer& quadHostBuffer, const Buffer& quadDeviceBuffer, VkDeviceSize indexOffset, const Settings& settings)
+int RunOutOfCore(const Settings& settings)
 {
-  // define all needed handles, so it's easier to clean them up afterwards
-  // the order is the order of allocation
-  // so deallocate/free/destroy in reverse order
-  VkCommandPool commandPool;
-  VkCommandBuffer cmdBuffer;
-  VkFence fence;
+  // resumes where the last run stopped, only a missing file gets seeded
+  OutOfCoreBoard board;
+  if (std::ifstream(settings.outOfCorePath).good())
+  {
+    if (!board.Open(settings.outOfCorePath, settings.topology))
+    {
+      std::cout << "could not open " << settings.outOfCorePath << " as a packed board of a single generation" << std::endl;
+      GETOUT(1);
+    }
+  }
+  else if (!board.Create(settings.outOfCorePath, settings.imageWidth, settings.imageHeight, settings.density, settings.seed, settings.positions, settings.topology))
+  {
+    std::cout << "could not create " << settings.outOfCorePath << std::endl;
+    GETOUT(1);
+  }
 
-  VkDeviceSize initSize = sizeof(uint32_t) * positionCount;
-  auto initBufferCreation = CreateBuffer(physicalDevice, device, initSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-  CHECK_RESULT_BOOL(initBufferCreation);
-  Buffer initBuffer = std::get<Buffer>(initBufferCreation);
+  std::cout << board.Width() << "x" << board.Height() << " board at generation " << board.Generation() << std::endl;
 
+  // nothing looks at the board in between, so every pass over the file advances as many generations as it can
+  auto start = std::chrono::steady_clock::now();
+  if (!board.Step(settings.generations))
+  {
+    std::cout << "could not step generation " << board.Generation() << std::endl;
+    GETOUT(1);
+  }
 
+  if (!board.Flush())
+  {
+    std::cout << "could not flush " << settings.outOfCorePath << std::endl;
+    GETOUT(1);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-  // copy position data
-  void* data;
-  vkMapMemory(device, initBuffer.memory, 0, initSize, 0, &data);
-  memcpy(data, positions, initSize);
-  vkUnmapMemory(device, initBuffer.memory);
+  std::cout << settings.generations << " generations: " << settings.generations / elapsed.count() << " generations/s, " << board.CountCells() << " cells alive at generation " << board.Generation() << std::endl;
 
-  // create command buffer
-  auto commandPoolCreation = CreateCommandPool(device, physicalDevice.graphicsQueueIndex);
-  CHECK_RESULT_BOOL(commandPoolCreation);
-  commandPool = std::get<VkCommandPool>(commandPoolCreation);
+  PROFILE_WRITE();
+  return 0;
+}
 
-  auto result = AllocateCommandBuffer(device, commandPool, 1, &cmdBuffer);
-  if (result != VK_SUCCESS)
+int RunSparse(const Settings& settings)
+{
+  if (settings.density > 0.0)
   {
-    return false;
+    std::cout << "a sparse run only starts from the given positions, the soup density is ignored" << std::endl;
   }
 
-  // record command buffer
-  result = BeginCommandBuffer(cmdBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-  if (result != VK_SUCCESS)
+  SparseEngine engine(settings.imageWidth, settings.imageHeight, settings.topology);
+  engine.SetCells(settings.positions);
+
+  auto rowMajor = [](const Position& a, const Position& b) { return a.y != b.y ? a.y < b.y : a.x < b.x; };
+  std::map<std::string, uint64_t> escaped;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t generation = 0; generation < settings.generations; generation++)
   {
-    return false;
-  }
+    engine.Step();
 
-  // copy quad data from host to device
-  VkBufferCopy bufferRegion = {};
-  bufferRegion.dstOffset = 0;
-  bufferRegion.srcOffset = 0;
-  bufferRegion.size = quadDeviceBuffer.size;
+    // gliders and spaceships flying off would keep the activity growing for as long as the pattern emits them
+    if (settings.removeEscapees > 0 && (generation + 1) % settings.removeEscapees == 0)
+    {
+      std::vector<Position> cells = engine.Cells();
+      std::sort(cells.begin(), cells.end(), rowMajor);
 
-  vkCmdCopyBuffer(cmdBuffer, quadHostBuffer.buffer, quadDeviceBuffer.buffer, 1, &bufferRegion);
+      for (const auto& escapee : FindEscapees(cells))
+      {
+        std::cout << "generation " << generation + 1 << ": " << escapee.name << " escaped at " << escapee.cells[0].x << "," << escapee.cells[0].y << " heading " << escapee.dx << "," << escapee.dy << std::endl;
+        engine.ClearCells(escapee.cells);
+        escaped[escapee.name]++;
+      }
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 
-  TransitionImageLayout(cmdBuffer, image.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+  std::cout << settings.generations << " generations: " << settings.generations / elapsed.count() << " generations/s, " << engine.CountCells() << " cells alive, " << engine.Activity() << " changed in the last generation" << std::endl;
 
-  VkBufferImageCopy bufferImageRegion = {};
-  bufferImageRegion.bufferOffset = 0;
-  bufferImageRegion.bufferRowLength = 0;
-  bufferImageRegion.bufferImageHeight = 0;
-  bufferImageRegion.imageOffset = { 0, 0, 0 };
-  bufferImageRegion.imageExtent = { settings.imageWidth, settings.imageHeight, 1 };
-  bufferImageRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  bufferImageRegion.imageSubresource.mipLevel = 0;
-  bufferImageRegion.imageSubresource.baseArrayLayer = 0;
-  bufferImageRegion.imageSubresource.layerCount = 1;
+  for (const auto& count : escaped)
+  {
+    std::cout << count.second << " x " << count.first << " escaped and removed" << std::endl;
+  }
 
-  vkCmdCopyBufferToImage(cmdBuffer, initBuffer.buffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageRegion);
+  // same format as --UseFile like the other checkpoints, without ever unpacking the board
+  std::vector<Position> cells = engine.Cells();
+  std::sort(cells.begin(), cells.end(), rowMajor);
 
-  TransitionImageLayout(cmdBuffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+  std::ofstream f("checkpoint_" + std::to_string(settings.generations) + ".txt");
+  for (const auto& cell : cells)
+  {
+    f << cell.x << "," << cell.y << "\n";
+  }
 
-  result = vkEndCommandBuffer(cmdBuffer);
-  if (result != VK_SUCCESS)
+  if (!f.is_open() || f.bad())
   {
-    return false;
+    std::cout << "could not write checkpoint" << std::endl;
   }
 
-  // create fence for host sync
-  auto fenceCreation = CreateFence(device);
-  CHECK_RESULT_BOOL(fenceCreation);
-  fence = std::get<VkFence>(fenceCreation);
+  if (settings.census)
+  {
+    PrintCensus(settings.generations, TakeCensus(cells));
+  }
 
-  VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT };
-  VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
-  submitInfo.pNext = nullptr;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &cmdBuffer;
-  submitInfo.pWaitDstStageMask = waitStages;
+  PROFILE_WRITE();
+  return 0;
+}
 
-  result = vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence);
-  if (result != VK_SUCCESS)
+glm::ivec2 ScreenToCell(Camera& camera, const Settings& settings, double screenX, double screenY)
+{
+  // inverse of the board quad: x from 1 to -1 spans u from 0 to 1, y from -2 * ratio to 2 * ratio spans v from 0 to 1
+  float ratio = float(settings.imageHeight) / float(settings.imageWidth);
+  glm::vec4 world = camera.ScreenToWorld(uint32_t(std::max(screenX, 0.0)), uint32_t(std::max(screenY, 0.0)));
+
+  float u = (1.0f - world.x) / 2.0f;
+  float v = (world.y / (2.0f * ratio) + 1.0f) / 2.0f;
+
+  return { int32_t(std::floor(u * settings.imageWidth)), int32_t(std::floor(v * settings.imageHeight)) };
+}
+
+void PaintLine(glm::ivec2 from, glm::ivec2 to, bool alive, const Settings& settings, std::vector<CellEdit>* edits)
+{
+  // bresenham, so fast strokes stay connected
+  glm::ivec2 d = { std::abs(to.x - from.x), -std::abs(to.y - from.y) };
+  glm::ivec2 step = { from.x < to.x ? 1 : -1, from.y < to.y ? 1 : -1 };
+  int32_t error = d.x + d.y;
+
+  glm::ivec2 p = from;
+  while (true)
   {
-    return false;
+    if (p.x >= 0 && p.y >= 0 && uint32_t(p.x) < settings.imageWidth && uint32_t(p.y) < settings.imageHeight)
+    {
+      edits->push_back({ uint32_t(p.x), uint32_t(p.y), alive ? 1u : 0u });
+    }
+
+    if (p == to)
+    {
+      break;
+    }
+
+    int32_t e2 = 2 * error;
+    if (e2 >= d.y)
+    {
+      error += d.y;
+      p.x += step.x;
+    }
+    if (e2 <= d.x)
+    {
+      error += d.x;
+      p.y += step.y;
+    }
   }
+}
 
-  result = vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
-  if (result != VK_SUCCESS)
+VkPresentModeKHR ToVkPresentMode(PresentMode mode)
+{
+  switch (mode)
   {
-    return false;
+  case PresentMode::Fifo:
+    return VK_PRESENT_MODE_FIFO_KHR;
+  case PresentMode::Mailbox:
+    return VK_PRESENT_MODE_MAILBOX_KHR;
+  case PresentMode::Immediate:
+    return VK_PRESENT_MODE_IMMEDIATE_KHR;
   }
 
-  vkQueueWaitIdle(graphicsQueue);
+  return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+PackedBoard InitialBoard(const Settings& settings)
+{
+  PackedBoard board = RandomBoard(settings.imageWidth, settings.imageHeight, settings.density, settings.seed);
 
-  //cleanup
-  vkDestroyFence(device, fence, nullptr);
-  vkFreeCommandBuffers(device, commandPool, 1, &cmdBuffer);
-  vkDestroyCommandPool(device, commandPool, nullptr);
-  FreeBuffer(device, initBuffer);
-  return true;
+  for (auto& pos : settings.positions)
+  {
+    if (pos.x < settings.imageWidth && pos.y < settings.imageHeight)
+    {
+      SetCell(&board, pos.x, pos.y, true);
+    }
+  }
+
+  return board;
 }
 
 bool ReadSettings(int argc, char** argv, Settings* settings)
@@ -768,11 +2600,40 @@ bool ReadSettings(int argc, char** argv, Settings* settings)
     ("Help,h", "produce help message")
     ("WindowWidth,w", po::value<uint32_t>(&settings->windowWidth)->default_value(WIDTH), "sets the window width")
     ("WindowHeight,h", po::value<uint32_t>(&settings->windowHeight)->default_value(HEIGHT), "sets the window height")
-    ("FullScreen,f", po::value<bool>(&settings->fullScreen)->implicit_value(false), "if set, the window will be fullscreen with the given resolution")
+    ("FullScreen,f", po::bool_switch(&settings->fullScreen), "if set, the window will be fullscreen with the given resolution")
+    ("PresentMode", po::value<PresentMode>(&settings->presentMode)->default_value(PresentMode::Mailbox, "mailbox"), "fifo (vsync), mailbox (vsync, newest frame wins) or immediate (no vsync, may tear), falls back to fifo if not supported")
+    ("Throughput", po::bool_switch(&settings->throughput), "steps as fast as the GPU allows instead of at the step rate, frames only ever show the newest generation and never hold the steps back")
     ("ImageWidth,i", po::value<uint32_t>(&settings->imageWidth)->default_value(WIDTH), "sets the image's width (the resolution of \"Game of Life\")")
     ("ImageHeight,j", po::value<uint32_t>(&settings->imageHeight)->default_value(HEIGHT), "sets the image's height (the resolution of \"Game of Life\")")
+    ("RunAhead,a", po::value<uint32_t>(&settings->runAhead)->default_value(2), "how many generations the simulation may run ahead of the presented one")
+    ("HistoryBudget", po::value<uint32_t>(&settings->historyBudget)->default_value(64), "memory in MiB kept for rewinding (left/right arrow) and diffing (D) past generations")
+    ("KeyframeInterval", po::value<uint32_t>(&settings->keyframeInterval)->default_value(32), "every how many captured generations the history stores a full board instead of a delta")
+    ("Topology,t", po::value<Topology>(&settings->topology)->default_value(Topology::Plane, "plane"), "plane (dead cells beyond the edges) or torus (the edges wrap around)")
+    ("Backend,b", po::value<Backend>(&settings->backend)->default_value(Backend::Gpu, "gpu"), "gpu (compute shader) or cpu (bit parallel on the host, uploaded every step)")
+    ("Kernel,k", po::value<Kernel>(&settings->kernel)->default_value(Kernel::Tiled, "tiled"), "naive (nine texture fetches per cell), tiled (tile and halo loaded into shared memory once) or multi (several generations per dispatch in shared memory, see StepsPerDispatch)")
+    ("Rule", po::value<Rule>(&settings->rule)->default_value(LIFE_RULE, "life"), "life (B3/S23), bosco (Bosco's rule), any Larger than Life rule like R5,C0,M1,S34..58,B34..45,NM, or brain (Brian's Brain), starwars (Star Wars) and any Generations rule like 345/2/4 (survival/birth/states); rules other than life step interactively and with Verify, Generations rules with more than two states on the cpu backend only")
+    ("Heatmap", po::bool_switch(&settings->heatmap), "the step kernels track the age of every live cell, saturating at 255 generations, and the live cells are colored by it; gpu backend only, with the naive or tiled kernel or a rule other than life")
+    ("StepsPerDispatch", po::value<uint32_t>(&settings->stepsPerDispatch)->default_value(8), "generations the multi kernel advances per dispatch (1 to 16), every presented frame then moves on by that many")
+    ("Benchmark", po::value<uint32_t>(&settings->benchmark)->default_value(0), "if set, steps the given number of generations with every kernel and on the cpu with and without temporal blocking, prints the generations per second and exits")
+    ("Devices,d", po::value<uint32_t>(&settings->devices)->default_value(0), "if set, runs headless with the board split into that many horizontal strips, one logical device each (physical devices are reused when there are fewer)")
+    ("Batch", po::value<uint32_t>(&settings->batch)->default_value(0), "if set, runs headless with that many independent boards of the image size, seeded with Seed, Seed + 1 and so on, steps all of them at once (on the gpu, or on the cpu in bit lanes with Backend cpu) and prints which died out or settled")
+    ("Generations,g", po::value<uint32_t>(&settings->generations)->default_value(1000), "how many generations a headless run steps before writing the board as checkpoint")
+    ("Coordinate", po::value<uint32_t>(&settings->coordinate)->default_value(0), "if set, coordinates a distributed run of the given number of worker processes, each stepping a strip of the board")
+    ("Join", po::value<std::string>(&settings->join)->default_value(""), "runs as worker of the distributed run coordinated at host:port")
+    ("Port", po::value<uint32_t>(&settings->port)->default_value(0), "port the coordinator or worker listens on (0 picks a free one)")
+    ("Gather", po::bool_switch(&settings->gather), "the coordinator collects the whole board at the end of a distributed run and writes it as checkpoint")
+    ("Verify", po::bool_switch(&settings->verify), "steps the seed for the given number of generations on the cpu, with every kernel on every compute device and as strips, and compares every generation against a plain reference")
+    ("OutOfCore", po::value<std::string>(&settings->outOfCorePath)->default_value(""), "if set, steps the board kept in the given packed file for the given number of generations without loading it into memory, a missing file is seeded with the image size, density, seed and positions first")
+    ("Sparse", po::bool_switch(&settings->sparse), "if set, steps only the given positions and the cells around them on a board of the image size for the given number of generations, for a few patterns on a board far too large to hold (Density is ignored), and writes the live cells as checkpoint")
+    ("Census", po::bool_switch(&settings->census), "if set, the headless runs of strips, of a gathering coordinator and of sparse boards print which objects the final board consists of, still lifes, oscillators and spaceships by name; O prints it for the shown generation interactively")
+    ("RemoveEscapees", po::value<uint32_t>(&settings->removeEscapees)->default_value(0), "if set, a sparse run looks for gliders and spaceships that left the rest of the pattern behind every that many generations, logs and removes them, so guns and long soups keep a bounded activity; plane topology only")
+    ("Trace", po::value<std::string>(&settings->tracePath)->default_value(""), "if set, writes a chrome trace (chrome://tracing) of the host and GPU timings to the given file on exit, needs a build with GOL_PROFILE")
+    ("Export,e", po::value<std::string>(&settings->exportPath)->default_value(""), "if set, writes every generation to the given path in the background, stepping slows down instead of dropping generations when the disk can't keep up")
+    ("ExportFormat", po::value<ExportFormat>(&settings->exportFormat)->default_value(ExportFormat::Png, "png"), "png (1 bit images named <path>_<generation>.png), y4m (monochrome video stream) or packed (1 bit per cell frames with a small header)")
     ("UseFile,u", po::value<std::string>(), "Uses the given file filled with x and y coordinates (separated with ',') as initial pixel positions")
     ("Random,r", po::value<uint32_t>(), "Creates the given amount of random initial positions")
+    ("Density", po::value<double>(&settings->density)->default_value(0.0), "if set, seeds a random soup in which every cell is alive with the given probability (0 to 1), on top of any given positions")
+    ("Seed", po::value<uint64_t>(&settings->seed)->default_value(0), "seed of the soup, the same seed and size always give the same soup")
     ("Lua,l", po::value<std::string>(), "Reads the configuration from the lua file")
     ("Pixels,p", po::value<std::vector<Position>>(&settings->positions)->multitoken()->zero_tokens()->composing(), "positions of pixels which will be set initialilly to kick of \"Game of Life\"");
 
@@ -806,6 +2667,38 @@ bool ReadSettings(int argc, char** argv, Settings* settings)
     return false;
   }
 
+  if (settings->stepsPerDispatch < 1 || settings->stepsPerDispatch > MAX_STEPS_PER_DISPATCH)
+  {
+    std::cerr << "StepsPerDispatch has to be between 1 and " << MAX_STEPS_PER_DISPATCH << "\n";
+    return false;
+  }
+
+  if (settings->removeEscapees > 0 && (!settings->sparse || settings->topology != Topology::Plane))
+  {
+    std::cerr << "RemoveEscapees needs Sparse and the plane topology\n";
+    return false;
+  }
+
+  bool headless = settings->devices > 0 || settings->batch > 0 || !settings->outOfCorePath.empty() || settings->sparse || settings->coordinate > 0 || !settings->join.empty() || settings->benchmark > 0;
+  if (!IsLife(settings->rule) && headless)
+  {
+    std::cerr << "only the interactive path and Verify step rules other than life\n";
+    return false;
+  }
+
+  if (settings->rule.states > 2 && settings->backend != Backend::Cpu && !settings->verify)
+  {
+    std::cerr << "Generations rules only step with Backend cpu\n";
+    return false;
+  }
+
+  // the multi kernel keeps generations in shared memory as bits, the cpu backend uploads bits
+  if (settings->heatmap && (settings->backend != Backend::Gpu || (settings->kernel == Kernel::Multi && IsLife(settings->rule))))
+  {
+    std::cerr << "Heatmap needs Backend gpu and the naive or tiled kernel\n";
+    return false;
+  }
+
   if (vm.count("UseFile"))
   {
     std::vector<std::string> lines;
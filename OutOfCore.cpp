@@ -0,0 +1,348 @@
+#include "OutOfCore.h"
+#include "Export.h"
+#include "Profile.h"
+#include "Threads.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <fstream>
+
+namespace bip = boost::interprocess;
+
+// magic, width, height, words per row, then the generation of the only frame
+static constexpr uint64_t FRAME_OFFSET = 4 * sizeof(uint32_t) + sizeof(uint64_t);
+
+uint64_t OutOfCoreBoard::RowOffset(uint32_t row) const
+{
+  return FRAME_OFFSET + uint64_t(row) * wordsPerRow * sizeof(uint64_t);
+}
+
+bip::mapped_region OutOfCoreBoard::MapRows(uint32_t firstRow, uint32_t rows) const
+{
+  bip::mapped_region region(file, bip::read_write, bip::offset_t(RowOffset(firstRow)), size_t(rows) * wordsPerRow * sizeof(uint64_t));
+
+  // only a hint, the kernel starts reading while the rows before are still being stepped
+  region.advise(bip::mapped_region::advice_willneed);
+  return region;
+}
+
+bool OutOfCoreBoard::Create(const std::string& path, uint32_t width, uint32_t height, double density, uint64_t seed, const std::vector<Position>& positions, Topology topology,
+  size_t bandBytes, uint32_t threads)
+{
+  if (width == 0 || height == 0)
+  {
+    return false;
+  }
+
+  wordsPerRow = (width + 63) / 64;
+
+  {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+    {
+      return false;
+    }
+
+    uint32_t header[4] = { PACKED_MAGIC, width, height, wordsPerRow };
+    uint64_t generation = 0;
+    stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(&generation), sizeof(generation));
+
+    // sparse until the bands below are written
+    stream.seekp(std::streamoff(FRAME_OFFSET + uint64_t(height) * wordsPerRow * sizeof(uint64_t) - 1));
+    stream.put(0);
+    if (!stream)
+    {
+      return false;
+    }
+  }
+
+  if (!Open(path, topology, bandBytes, threads))
+  {
+    return false;
+  }
+
+  // sorted by row, so every band only looks at its own
+  std::vector<Position> sorted;
+  std::copy_if(positions.begin(), positions.end(), std::back_inserter(sorted), [&](const Position& pos) { return pos.x < width && pos.y < height; });
+  std::sort(sorted.begin(), sorted.end(), [](const Position& a, const Position& b) { return a.y < b.y; });
+  auto position = sorted.begin();
+
+  try
+  {
+    for (uint32_t firstRow = 0; firstRow < height; firstRow += bandRows)
+    {
+      uint32_t rows = std::min(bandRows, height - firstRow);
+
+      PackedBoard band = RandomBoard(width, rows, density, seed, firstRow);
+      for (; position != sorted.end() && position->y < firstRow + rows; ++position)
+      {
+        SetCell(&band, position->x, position->y - firstRow, true);
+      }
+
+      bip::mapped_region region = MapRows(firstRow, rows);
+      std::memcpy(region.get_address(), band.words.data(), band.words.size() * sizeof(uint64_t));
+      region.flush(0, 0, true);
+    }
+  }
+  catch (const bip::interprocess_exception&)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+bool OutOfCoreBoard::Open(const std::string& path, Topology topology, size_t bandBytes, uint32_t threads)
+{
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  if (!stream.is_open())
+  {
+    return false;
+  }
+
+  uint64_t size = uint64_t(stream.tellg());
+  stream.seekg(0);
+
+  uint32_t header[4];
+  stream.read(reinterpret_cast<char*>(header), sizeof(header));
+  stream.read(reinterpret_cast<char*>(&generation), sizeof(generation));
+  if (!stream || header[0] != PACKED_MAGIC || header[1] == 0 || header[2] == 0 || header[3] != (header[1] + 63) / 64)
+  {
+    return false;
+  }
+
+  width = header[1];
+  height = header[2];
+  wordsPerRow = header[3];
+  this->topology = topology;
+
+  // exactly one frame, stepping a longer export in place would leave the frames after it stale
+  if (size != RowOffset(height))
+  {
+    return false;
+  }
+
+  try
+  {
+    file = bip::file_mapping(path.c_str(), bip::read_write);
+  }
+  catch (const bip::interprocess_exception&)
+  {
+    return false;
+  }
+
+  bandRows = uint32_t(std::min<size_t>(std::max<size_t>(bandBytes / (size_t(wordsPerRow) * sizeof(uint64_t)), 1), height));
+  uint32_t bands = (height + bandRows - 1) / bandRows;
+  threadCount = threads > 0 ? std::min(threads, bands) : ThreadCount(bands);
+  window.reset();
+
+  return true;
+}
+
+uint64_t OutOfCoreBoard::CountCells() const
+{
+  uint64_t count = 0;
+
+  try
+  {
+    for (uint32_t firstRow = 0; firstRow < height; firstRow += bandRows)
+    {
+      uint32_t rows = std::min(bandRows, height - firstRow);
+      bip::mapped_region region = MapRows(firstRow, rows);
+      const uint64_t* words = static_cast<const uint64_t*>(region.get_address());
+
+      // padding bits are always written as zeros
+      for (size_t i = 0; i < size_t(rows) * wordsPerRow; i++)
+      {
+        count += std::bitset<64>(words[i]).count();
+      }
+    }
+  }
+  catch (const bip::interprocess_exception&)
+  {
+    return 0;
+  }
+
+  return count;
+}
+
+bool OutOfCoreBoard::GetBoard(PackedBoard* board) const
+{
+  *board = CreatePackedBoard(width, height);
+
+  try
+  {
+    for (uint32_t firstRow = 0; firstRow < height; firstRow += bandRows)
+    {
+      uint32_t rows = std::min(bandRows, height - firstRow);
+      bip::mapped_region region = MapRows(firstRow, rows);
+      const uint64_t* words = static_cast<const uint64_t*>(region.get_address());
+
+      std::copy(words, words + size_t(rows) * wordsPerRow, board->words.begin() + size_t(firstRow) * wordsPerRow);
+    }
+  }
+  catch (const bip::interprocess_exception&)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void OutOfCoreBoard::ReadRow(int64_t row, uint64_t* words) const
+{
+  bip::mapped_region region = MapRows(uint32_t((row % height + height) % height), 1);
+  std::memcpy(words, region.get_address(), size_t(wordsPerRow) * sizeof(uint64_t));
+}
+
+bool OutOfCoreBoard::Step(uint32_t generations)
+{
+  while (generations > 0)
+  {
+    uint32_t block = std::min(generations, CpuEngine::TEMPORAL_BLOCK);
+    if (!Pass(block))
+    {
+      return false;
+    }
+    generations -= block;
+  }
+
+  return true;
+}
+
+bool OutOfCoreBoard::Pass(uint32_t generations)
+{
+  PROFILE_SCOPE("out of core pass");
+
+  uint32_t batchRows = bandRows * threadCount;
+  bool torus = topology == Topology::Torus;
+
+  // a row further away than generations can't reach the batch before the pass ends
+  uint32_t halo = generations;
+  size_t haloWords = size_t(halo) * wordsPerRow;
+
+  // the rows above the current batch, and the first rows for the torus' last batch, all as they were before this pass
+  std::vector<uint64_t> above(haloWords);
+  std::vector<uint64_t> wrapped(haloWords);
+  std::vector<uint64_t> below(haloWords);
+
+  try
+  {
+    if (torus)
+    {
+      for (uint32_t i = 0; i < halo; i++)
+      {
+        ReadRow(int64_t(i) - halo, &above[size_t(i) * wordsPerRow]);
+        ReadRow(i, &wrapped[size_t(i) * wordsPerRow]);
+      }
+    }
+
+    bip::mapped_region next = MapRows(0, std::min(batchRows, height));
+    for (uint32_t firstRow = 0; firstRow < height; )
+    {
+      PROFILE_SCOPE("out of core batch");
+
+      uint32_t rows = std::min(batchRows, height - firstRow);
+      uint32_t end = firstRow + rows;
+      bip::mapped_region batch(std::move(next));
+      if (end < height)
+      {
+        next = MapRows(end, std::min(batchRows, height - end));
+      }
+
+      uint64_t* words = static_cast<uint64_t*>(batch.get_address());
+
+      // the batch with its halo, cut at the edges of the plane; the rows below aren't written before the batches they belong to
+      uint32_t haloAbove = torus ? halo : std::min(halo, firstRow);
+      uint32_t haloBelow = torus ? halo : std::min(halo, height - end);
+      for (uint32_t i = 0; i < haloBelow; i++)
+      {
+        if (end + i < height)
+        {
+          ReadRow(end + i, &below[size_t(i) * wordsPerRow]);
+        }
+        else
+        {
+          std::copy_n(&wrapped[size_t(end + i - height) * wordsPerRow], wordsPerRow, &below[size_t(i) * wordsPerRow]);
+        }
+      }
+
+      uint32_t windowRows = haloAbove + rows + haloBelow;
+      if (!window || window->Height() != windowRows)
+      {
+        window = std::make_unique<CpuEngine>(width, windowRows, topology);
+      }
+
+      for (uint32_t i = 0; i < haloAbove; i++)
+      {
+        window->SetRow(i, &above[size_t(halo - haloAbove + i) * wordsPerRow]);
+      }
+
+      for (uint32_t y = 0; y < rows; y++)
+      {
+        window->SetRow(haloAbove + y, &words[size_t(y) * wordsPerRow]);
+      }
+
+      for (uint32_t i = 0; i < haloBelow; i++)
+      {
+        window->SetRow(haloAbove + rows + i, &below[size_t(i) * wordsPerRow]);
+      }
+
+      // the edges of the window go wrong by a row per generation, but never further than the halo
+      window->StepBlocked(generations);
+
+      // the old rows above the next batch, from this batch and from the ones before it when it is shorter than the halo
+      std::vector<uint64_t> nextAbove(haloWords);
+      for (uint32_t i = 0; i < halo; i++)
+      {
+        int64_t row = int64_t(end) - halo + i;
+        const uint64_t* source = row >= firstRow ? &words[size_t(row - firstRow) * wordsPerRow] : &above[size_t(row - (int64_t(firstRow) - halo)) * wordsPerRow];
+        std::copy_n(source, wordsPerRow, &nextAbove[size_t(i) * wordsPerRow]);
+      }
+      above.swap(nextAbove);
+
+      for (uint32_t y = 0; y < rows; y++)
+      {
+        std::memcpy(&words[size_t(y) * wordsPerRow], window->Row(haloAbove + y), size_t(wordsPerRow) * sizeof(uint64_t));
+      }
+
+      // written back in the background while the next batch is stepped
+      batch.flush(0, 0, true);
+      firstRow = end;
+    }
+
+    generation += generations;
+    bip::mapped_region header(file, bip::read_write, bip::offset_t(4 * sizeof(uint32_t)), sizeof(uint64_t));
+    std::memcpy(header.get_address(), &generation, sizeof(generation));
+  }
+  catch (const bip::interprocess_exception&)
+  {
+    return false;
+  }
+
+  return true;
+}
+
+bool OutOfCoreBoard::Flush()
+{
+  try
+  {
+    for (uint32_t firstRow = 0; firstRow < height; firstRow += bandRows)
+    {
+      bip::mapped_region region(file, bip::read_write, bip::offset_t(RowOffset(firstRow)), size_t(std::min(bandRows, height - firstRow)) * wordsPerRow * sizeof(uint64_t));
+      if (!region.flush(0, 0, false))
+      {
+        return false;
+      }
+    }
+
+    bip::mapped_region header(file, bip::read_write, 0, size_t(FRAME_OFFSET));
+    return header.flush(0, 0, false);
+  }
+  catch (const bip::interprocess_exception&)
+  {
+    return false;
+  }
+}
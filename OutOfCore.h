@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "Structs.h"
+#include "Board.h"
+#include "CpuEngine.h"
+
+// A board larger than memory, stepped in place inside a memory mapped file.
+// The file is a packed export holding a single frame, so it can be resumed, archived and converted like one.
+// A pass streams through the file in batches of row bands while the next batch is already read ahead: every batch
+// is loaded with as many rows above and below as it advances generations, up to CpuEngine::TEMPORAL_BLOCK of them
+// at once with StepBlocked over all cores, then written back. So the file moves through memory once per block of
+// generations instead of once per generation. Only the rows next to a batch are held aside in memory, the rest of
+// the board only ever lives in the page cache.
+class OutOfCoreBoard
+{
+private:
+  // enough rows per band to keep every thread busy, small enough that a batch of them fits into memory easily
+  static constexpr size_t BAND_BYTES = size_t(16) << 20;
+
+  boost::interprocess::file_mapping file;
+  uint32_t width;
+  uint32_t height;
+  uint32_t wordsPerRow;
+  uint32_t bandRows;
+  // bands per batch
+  uint32_t threadCount;
+  uint64_t generation;
+  Topology topology;
+
+  // a batch with its halo, only created again when a batch at an edge of the plane or the last one is shorter
+  std::unique_ptr<CpuEngine> window;
+
+  uint64_t RowOffset(uint32_t row) const;
+  boost::interprocess::mapped_region MapRows(uint32_t firstRow, uint32_t rows) const;
+
+  // any row, wrapped around the board
+  void ReadRow(int64_t row, uint64_t* words) const;
+
+  // at most TEMPORAL_BLOCK generations in one pass over the file
+  bool Pass(uint32_t generations);
+
+public:
+  OutOfCoreBoard() = default;
+  ~OutOfCoreBoard() = default;
+
+  // a soup like RandomBoard with the positions set on top, written band by band without ever holding the board
+  bool Create(const std::string& path, uint32_t width, uint32_t height, double density, uint64_t seed, const std::vector<Position>& positions, Topology topology,
+    size_t bandBytes = BAND_BYTES, uint32_t threads = 0);
+
+  // a file written by Create or a packed export of a single generation;
+  // bands of at most bandBytes each and that many bands per batch, one per core for 0
+  bool Open(const std::string& path, Topology topology, size_t bandBytes = BAND_BYTES, uint32_t threads = 0);
+
+  uint32_t Width() const { return width; }
+  uint32_t Height() const { return height; }
+  uint64_t Generation() const { return generation; }
+  uint64_t CountCells() const;
+
+  // the whole board in memory, only for boards small enough like the ones of Verify
+  bool GetBoard(PackedBoard* board) const;
+
+  bool Step(uint32_t generations = 1);
+
+  // blocks until everything stepped so far is on disk
+  bool Flush();
+};
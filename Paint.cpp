@@ -0,0 +1,161 @@
+#include "Paint.h"
+#include "GameOfLifeVulkan.h"
+#include "Profile.h"
+
+#include <algorithm>
+
+VkResult BoardPainter::Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, uint32_t slotCount)
+{
+  nextSlot = 0;
+
+  auto result = pass.Create(physicalDevice, device, vkCmdPushDescriptorSetKHR, "paint.comp.spv");
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  slots.resize(slotCount);
+  for (auto& slot : slots)
+  {
+    slot.buffer = {};
+    slot.edits = nullptr;
+    slot.capacity = 0;
+    slot.pending = false;
+
+    result = pass.AllocateSubmission(&slot.command, &slot.fence);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    // a stroke of a few hundred cells per frame is the common case, larger batches grow the buffer
+    result = Reserve(slot, 4096);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+  }
+
+  return VK_SUCCESS;
+}
+
+void BoardPainter::Destroy()
+{
+  for (auto& slot : slots)
+  {
+    vkDestroyFence(pass.device, slot.fence, nullptr);
+    if (slot.edits)
+    {
+      pass.FreeMappedBuffer(slot.buffer);
+    }
+  }
+
+  pass.Destroy();
+}
+
+VkResult BoardPainter::Reserve(Slot& slot, uint32_t count)
+{
+  if (count <= slot.capacity)
+  {
+    return VK_SUCCESS;
+  }
+
+  if (slot.edits)
+  {
+    pass.FreeMappedBuffer(slot.buffer);
+    slot.edits = nullptr;
+    slot.capacity = 0;
+  }
+
+  void* data;
+  auto result = pass.CreateMappedBuffer(VkDeviceSize(count) * sizeof(CellEdit), &slot.buffer, &data);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  slot.edits = (CellEdit*)data;
+  slot.capacity = count;
+  return VK_SUCCESS;
+}
+
+VkResult BoardPainter::Apply(VkQueue computeQueue, const Image2D& source, const Image2D& target, const std::vector<CellEdit>& edits, const std::vector<SemaphoreSubmit>& waits, SemaphoreSubmit signal)
+{
+  PROFILE_SCOPE("paint");
+
+  // batches are rare next to the steps, so simply wait for the oldest slot instead of dropping edits
+  Slot& slot = slots[nextSlot];
+  nextSlot = (nextSlot + 1) % uint32_t(slots.size());
+
+  if (slot.pending)
+  {
+    auto result = vkWaitForFences(pass.device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    vkResetFences(pass.device, 1, &slot.fence);
+    slot.pending = false;
+  }
+
+  auto result = Reserve(slot, uint32_t(edits.size()));
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  // the scatter has no order between invocations, so only the last edit of every cell is uploaded
+  std::vector<CellEdit> sorted = edits;
+  std::stable_sort(sorted.begin(), sorted.end(), [](const CellEdit& a, const CellEdit& b)
+  {
+    return a.y < b.y || (a.y == b.y && a.x < b.x);
+  });
+
+  uint32_t count = 0;
+  for (size_t i = 0; i < sorted.size(); i++)
+  {
+    if (i + 1 < sorted.size() && sorted[i + 1].x == sorted[i].x && sorted[i + 1].y == sorted[i].y)
+    {
+      continue;
+    }
+
+    slot.edits[count++] = sorted[i];
+  }
+
+  vkResetCommandBuffer(slot.command, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+  result = BeginCommandBuffer(slot.command, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  // the copy replaces the whole target, so its old content is dropped once earlier readbacks on this queue are done with it
+  TransitionImageLayout(slot.command, target.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  VkImageCopy region = {};
+  region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+  region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+  region.extent = { target.width, target.height, 1 };
+  vkCmdCopyImage(slot.command, source.image, VK_IMAGE_LAYOUT_GENERAL, target.image, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+
+  TransitionImageLayout(slot.command, target.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  pass.Bind(slot.command, target, slot.buffer.buffer, count);
+  vkCmdDispatch(slot.command, (count + 63) / 64, 1, 1);
+
+  result = vkEndCommandBuffer(slot.command);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  result = QueueSubmit(computeQueue, slot.command, waits, { signal }, slot.fence);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  slot.pending = true;
+  return VK_SUCCESS;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Structs.h"
+#include "GameOfLifeVulkan.h"
+
+// Applies batches of edited cells to the board on the compute queue.
+// The edited generation is a device side copy of the previous one with the edits scattered into it,
+// so only the edits themselves travel to the GPU, through a small ring of persistently mapped buffers.
+class BoardPainter
+{
+private:
+  struct Slot
+  {
+    Buffer buffer;
+    CellEdit* edits;
+    uint32_t capacity;
+    VkCommandBuffer command;
+    VkFence fence;
+    bool pending;
+  };
+
+  ComputePass pass;
+
+  std::vector<Slot> slots;
+  uint32_t nextSlot;
+
+  VkResult Reserve(Slot& slot, uint32_t count);
+
+public:
+  BoardPainter() = default;
+  ~BoardPainter() = default;
+
+  VkResult Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, uint32_t slotCount);
+  void Destroy();
+
+  // writes source with the edits applied to target, later edits of the same cell win
+  VkResult Apply(VkQueue computeQueue, const Image2D& source, const Image2D& target, const std::vector<CellEdit>& edits, const std::vector<SemaphoreSubmit>& waits, SemaphoreSubmit signal);
+};
@@ -0,0 +1,308 @@
+#include "Profile.h"
+
+#ifdef GOL_PROFILE
+
+#include "GameOfLifeVulkan.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+
+static void WriteJsonString(std::ofstream& out, const std::string& value)
+{
+  out << '"';
+  for (char c : value)
+  {
+    if (c == '"' || c == '\\')
+    {
+      out << '\\';
+    }
+    out << c;
+  }
+  out << '"';
+}
+
+Profiler::Profiler() : enabled(false), nextThread(0), nextQueue(0), dropped(false)
+{
+
+}
+
+Profiler& Profiler::Instance()
+{
+  static Profiler profiler;
+  return profiler;
+}
+
+void Profiler::Start(const std::string& path)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->path = path;
+    origin = std::chrono::steady_clock::now();
+    events.reserve(MAX_EVENTS / 16);
+  }
+
+  enabled = true;
+}
+
+int64_t Profiler::Now() const
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+uint32_t Profiler::ThreadId()
+{
+  thread_local uint32_t id = nextThread++;
+  return id;
+}
+
+void Profiler::NameThread(const char* name)
+{
+  uint32_t thread = ThreadId();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  tracks.push_back({ 0, thread, name });
+}
+
+uint32_t Profiler::AddQueueTrack(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  uint32_t thread = nextQueue++;
+  tracks.push_back({ 1, thread, name });
+  return thread;
+}
+
+void Profiler::Add(const Event& event)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (events.size() < MAX_EVENTS)
+  {
+    events.push_back(event);
+  }
+  else
+  {
+    dropped = true;
+  }
+}
+
+void Profiler::Span(const char* name, uint32_t process, uint32_t thread, int64_t start, int64_t duration, uint64_t generation)
+{
+  Add({ name, 'X', process, thread, start, duration, generation, 0.0 });
+}
+
+void Profiler::Counter(const char* name, double value)
+{
+  Add({ name, 'C', 0, ThreadId(), Now(), 0, NO_GENERATION, value });
+}
+
+bool Profiler::Write()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::ofstream out(path);
+  if (!out.is_open())
+  {
+    return false;
+  }
+
+  // chrome traces count in microseconds, fractions keep the nanoseconds
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"host\"}},\n";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"gpu\"}}";
+
+  for (const auto& track : tracks)
+  {
+    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << track.process << ",\"tid\":" << track.thread << ",\"args\":{\"name\":";
+    WriteJsonString(out, track.name);
+    out << "}}";
+  }
+
+  for (const auto& event : events)
+  {
+    out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"pid\":" << event.process << ",\"tid\":" << event.thread << ",\"ts\":" << event.start / 1000.0;
+
+    if (event.phase == 'C')
+    {
+      out << ",\"args\":{\"value\":" << event.value << "}}";
+      continue;
+    }
+
+    out << ",\"dur\":" << event.duration / 1000.0;
+    if (event.generation != NO_GENERATION)
+    {
+      out << ",\"args\":{\"generation\":" << event.generation << "}";
+    }
+    out << "}";
+  }
+
+  out << "\n]}\n";
+
+  if (dropped)
+  {
+    std::cout << "the trace only holds the first " << MAX_EVENTS << " events" << std::endl;
+  }
+
+  return !out.bad();
+}
+
+VkResult GpuProfiler::Create(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamily, const std::string& name, uint32_t capacity)
+{
+  this->device = device;
+  queryPool = VK_NULL_HANDLE;
+  written = 0;
+  collected = 0;
+  queries.resize(capacity);
+
+  uint32_t familyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+  std::vector<VkQueueFamilyProperties> families(familyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+  uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+  if (!Profiler::Instance().Enabled() || validBits == 0)
+  {
+    return VK_SUCCESS;
+  }
+
+  validMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+  period = physicalDevice.properties.limits.timestampPeriod;
+  track = Profiler::Instance().AddQueueTrack(name);
+
+  VkQueryPoolCreateInfo queryPoolInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+  queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  queryPoolInfo.queryCount = 2 * capacity;
+
+  auto result = vkCreateQueryPool(device, &queryPoolInfo, nullptr, &queryPool);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  // a single timestamp taken while the host waits for it, its tick lies between the two host times
+  auto commandPoolCreation = CreateCommandPool(device, queueFamily);
+  if (std::holds_alternative<VkResult>(commandPoolCreation))
+  {
+    return std::get<VkResult>(commandPoolCreation);
+  }
+  VkCommandPool commandPool = std::get<VkCommandPool>(commandPoolCreation);
+
+  VkCommandBuffer cmd;
+  result = AllocateCommandBuffer(device, commandPool, 1, &cmd);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  result = BeginCommandBuffer(cmd, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  vkCmdResetQueryPool(cmd, queryPool, 0, 1);
+  vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+
+  result = vkEndCommandBuffer(cmd);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  auto fenceCreation = CreateFence(device);
+  if (std::holds_alternative<VkResult>(fenceCreation))
+  {
+    return std::get<VkResult>(fenceCreation);
+  }
+  VkFence fence = std::get<VkFence>(fenceCreation);
+
+  int64_t before = Profiler::Instance().Now();
+  result = QueueSubmit(queue, cmd, {}, {}, fence);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  result = vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+  int64_t after = Profiler::Instance().Now();
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  uint64_t ticks;
+  result = vkGetQueryPoolResults(device, queryPool, 0, 1, sizeof(ticks), &ticks, sizeof(ticks), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  offset = 0;
+  offset = (before + after) / 2 - ToHost(ticks);
+
+  vkDestroyFence(device, fence, nullptr);
+  vkFreeCommandBuffers(device, commandPool, 1, &cmd);
+  vkDestroyCommandPool(device, commandPool, nullptr);
+  return VK_SUCCESS;
+}
+
+void GpuProfiler::Destroy()
+{
+  if (queryPool != VK_NULL_HANDLE)
+  {
+    vkDestroyQueryPool(device, queryPool, nullptr);
+  }
+}
+
+int64_t GpuProfiler::ToHost(uint64_t ticks) const
+{
+  return int64_t(double(ticks & validMask) * period) + offset;
+}
+
+uint32_t GpuProfiler::Begin(VkCommandBuffer cmd, const char* name, uint64_t generation)
+{
+  if (queryPool == VK_NULL_HANDLE || written - collected == queries.size())
+  {
+    return UINT32_MAX;
+  }
+
+  uint32_t query = uint32_t(written++ % queries.size());
+  queries[query] = { name, generation };
+
+  vkCmdResetQueryPool(cmd, queryPool, 2 * query, 2);
+  vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 2 * query);
+  return query;
+}
+
+void GpuProfiler::End(VkCommandBuffer cmd, uint32_t query)
+{
+  if (query != UINT32_MAX)
+  {
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 2 * query + 1);
+  }
+}
+
+void GpuProfiler::Collect()
+{
+  // pairs finish in the order they were submitted, the first one still in flight ends the collection
+  while (collected < written)
+  {
+    uint32_t query = uint32_t(collected % queries.size());
+
+    // begin, availability, end, availability
+    std::array<uint64_t, 4> results;
+    auto result = vkGetQueryPoolResults(device, queryPool, 2 * query, 2, sizeof(results), results.data(), 2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS || results[1] == 0 || results[3] == 0)
+    {
+      break;
+    }
+
+    int64_t start = ToHost(results[0]);
+    int64_t end = ToHost(results[2]);
+    Profiler::Instance().Span(queries[query].name, 1, track, start, std::max<int64_t>(end - start, 0), queries[query].generation);
+    collected++;
+  }
+}
+
+#endif
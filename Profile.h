@@ -0,0 +1,169 @@
+#pragma once
+
+// Scoped CPU timers, GPU timestamps and counters, written as Chrome trace JSON
+// (chrome://tracing or ui.perfetto.dev) to the path given with --Trace.
+// Only compiled with GOL_PROFILE defined, otherwise every PROFILE_ macro expands to nothing.
+
+#ifdef GOL_PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Structs.h"
+
+class Profiler
+{
+public:
+  static constexpr uint64_t NO_GENERATION = UINT64_MAX;
+
+private:
+  struct Event
+  {
+    const char* name; // string literals only, they are written long after the scope is gone
+    char phase; // 'X' for a span, 'C' for a counter
+    uint32_t process; // 0 for the host, 1 for the GPU
+    uint32_t thread; // host thread or GPU queue
+    int64_t start; // ns since Start
+    int64_t duration;
+    uint64_t generation;
+    double value;
+  };
+
+  struct Track
+  {
+    uint32_t process;
+    uint32_t thread;
+    std::string name;
+  };
+
+  // a long session only keeps its beginning, instead of growing without bound
+  static constexpr size_t MAX_EVENTS = size_t(1) << 20;
+
+  std::atomic<bool> enabled;
+  std::string path;
+  std::chrono::steady_clock::time_point origin;
+
+  std::mutex mutex;
+  std::vector<Event> events;
+  std::vector<Track> tracks;
+  std::atomic<uint32_t> nextThread;
+  uint32_t nextQueue;
+  bool dropped;
+
+  Profiler();
+  void Add(const Event& event);
+
+public:
+  static Profiler& Instance();
+
+  void Start(const std::string& path);
+  bool Enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+  // ns since Start
+  int64_t Now() const;
+
+  uint32_t ThreadId();
+  void NameThread(const char* name);
+  uint32_t AddQueueTrack(const std::string& name);
+
+  void Span(const char* name, uint32_t process, uint32_t thread, int64_t start, int64_t duration, uint64_t generation = NO_GENERATION);
+  void Counter(const char* name, double value);
+
+  // writes everything recorded so far, recording goes on afterwards
+  bool Write();
+};
+
+class ProfileScope
+{
+private:
+  const char* name;
+  int64_t start;
+
+public:
+  ProfileScope(const char* name) : name(name), start(Profiler::Instance().Enabled() ? Profiler::Instance().Now() : -1)
+  {
+
+  }
+
+  ~ProfileScope()
+  {
+    if (start >= 0)
+    {
+      Profiler& profiler = Profiler::Instance();
+      profiler.Span(name, 0, profiler.ThreadId(), start, profiler.Now() - start);
+    }
+  }
+
+  ProfileScope(const ProfileScope& scope) = delete;
+  ProfileScope& operator=(const ProfileScope& scope) = delete;
+};
+
+// Timestamps around work recorded into command buffers of one queue, kept in a ring of query pairs.
+// Only used from one thread; Collect picks up the finished pairs without waiting and maps them
+// onto the host clock, which is calibrated once at Create.
+class GpuProfiler
+{
+private:
+  struct Query
+  {
+    const char* name;
+    uint64_t generation;
+  };
+
+  VkDevice device;
+  VkQueryPool queryPool;
+  double period;
+  uint64_t validMask;
+  int64_t offset;
+  uint32_t track;
+
+  std::vector<Query> queries;
+  uint64_t written;
+  uint64_t collected;
+
+  int64_t ToHost(uint64_t ticks) const;
+
+public:
+  GpuProfiler() = default;
+  ~GpuProfiler() = default;
+
+  // without timestamp support on the queue family every Begin is ignored
+  VkResult Create(const PhysicalDevice& physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamily, const std::string& name, uint32_t capacity = 256);
+  void Destroy();
+
+  // outside of render passes, UINT32_MAX when profiling is off or every pair is still in flight
+  uint32_t Begin(VkCommandBuffer cmd, const char* name, uint64_t generation = Profiler::NO_GENERATION);
+  void End(VkCommandBuffer cmd, uint32_t query);
+
+  void Collect();
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::Instance().NameThread(name)
+#define PROFILE_COUNTER(name, value) do { if (Profiler::Instance().Enabled()) { Profiler::Instance().Counter(name, double(value)); } } while (false)
+#define PROFILE_GPU_BEGIN(query, profiler, cmd, name, generation) uint32_t query = (profiler).Begin(cmd, name, generation)
+#define PROFILE_GPU_END(query, profiler, cmd) (profiler).End(cmd, query)
+#define PROFILE_GPU_COLLECT(profiler) (profiler).Collect()
+#define PROFILE_WRITE() do { if (Profiler::Instance().Enabled() && !Profiler::Instance().Write()) { std::cout << "could not write trace" << std::endl; } } while (false)
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_THREAD(name)
+#define PROFILE_COUNTER(name, value)
+#define PROFILE_GPU_BEGIN(query, profiler, cmd, name, generation)
+#define PROFILE_GPU_END(query, profiler, cmd)
+#define PROFILE_GPU_COLLECT(profiler)
+#define PROFILE_WRITE()
+
+#endif
@@ -0,0 +1,132 @@
+#include "Readback.h"
+#include "GameOfLifeVulkan.h"
+#include "Profile.h"
+
+#include <algorithm>
+#include <cstring>
+
+VkResult BoardReadback::Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, uint32_t width, uint32_t height, uint32_t slotCount)
+{
+  this->width = width;
+  this->height = height;
+
+  auto result = pass.Create(physicalDevice, device, vkCmdPushDescriptorSetKHR, "pack.comp.spv");
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  PackedBoard layout = CreatePackedBoard(width, height);
+  VkDeviceSize size = layout.words.size() * sizeof(uint64_t);
+
+  slots.resize(slotCount);
+  for (auto& slot : slots)
+  {
+    slot.generation = 0;
+    slot.pending = false;
+
+    result = pass.CreateMappedBuffer(size, &slot.buffer, &slot.data);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    result = pass.AllocateSubmission(&slot.command, &slot.fence);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+  }
+
+  return VK_SUCCESS;
+}
+
+void BoardReadback::Destroy()
+{
+  for (auto& slot : slots)
+  {
+    vkDestroyFence(pass.device, slot.fence, nullptr);
+    pass.FreeMappedBuffer(slot.buffer);
+  }
+
+  pass.Destroy();
+}
+
+VkResult BoardReadback::Request(VkQueue computeQueue, const Image2D& image, SemaphoreSubmit wait, uint64_t generation, bool* accepted)
+{
+  PROFILE_SCOPE("readback request");
+
+  *accepted = false;
+
+  auto slot = std::find_if(slots.begin(), slots.end(), [](const Slot& s) { return !s.pending; });
+  if (slot == slots.end())
+  {
+    return VK_SUCCESS;
+  }
+
+  uint32_t wordsPerRow = 2 * CreatePackedBoard(width, 1).wordsPerRow;
+
+  vkResetCommandBuffer(slot->command, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+  auto result = BeginCommandBuffer(slot->command, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  pass.Bind(slot->command, image, slot->buffer.buffer, wordsPerRow);
+  vkCmdDispatch(slot->command, (wordsPerRow + 63) / 64, height, 1);
+
+  result = vkEndCommandBuffer(slot->command);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  result = QueueSubmit(computeQueue, slot->command, { wait }, {}, slot->fence);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  slot->generation = generation;
+  slot->pending = true;
+  *accepted = true;
+
+  return VK_SUCCESS;
+}
+
+void BoardReadback::Collect(const std::function<void(uint64_t generation, PackedBoard&& board)>& callback)
+{
+  PROFILE_SCOPE("readback collect");
+
+  // hand the boards over in generation order, a later one is held back until the earlier ones are done
+  while (true)
+  {
+    auto slot = slots.end();
+    for (auto s = slots.begin(); s != slots.end(); s++)
+    {
+      if (s->pending && (slot == slots.end() || s->generation < slot->generation))
+      {
+        slot = s;
+      }
+    }
+
+    if (slot == slots.end() || vkGetFenceStatus(pass.device, slot->fence) != VK_SUCCESS)
+    {
+      return;
+    }
+
+    PackedBoard board = CreatePackedBoard(width, height);
+    memcpy(board.words.data(), slot->data, board.words.size() * sizeof(uint64_t));
+
+    vkResetFences(pass.device, 1, &slot->fence);
+    slot->pending = false;
+
+    callback(slot->generation, std::move(board));
+  }
+}
+
+bool BoardReadback::CanRequest() const
+{
+  return std::any_of(slots.begin(), slots.end(), [](const Slot& s) { return !s.pending; });
+}
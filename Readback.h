@@ -0,0 +1,46 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Structs.h"
+#include "Board.h"
+#include "GameOfLifeVulkan.h"
+
+// Packs board images into PackedBoard words on the compute queue and reads them back
+// through a small ring of persistently mapped buffers, without the host ever waiting on the GPU.
+class BoardReadback
+{
+private:
+  struct Slot
+  {
+    Buffer buffer;
+    void* data;
+    VkCommandBuffer command;
+    VkFence fence;
+    uint64_t generation;
+    bool pending;
+  };
+
+  ComputePass pass;
+
+  uint32_t width;
+  uint32_t height;
+  std::vector<Slot> slots;
+
+public:
+  BoardReadback() = default;
+  ~BoardReadback() = default;
+
+  VkResult Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, uint32_t width, uint32_t height, uint32_t slotCount);
+  void Destroy();
+
+  // the copy waits on the GPU for wait, if every slot is still in flight the request is dropped and accepted is false
+  VkResult Request(VkQueue computeQueue, const Image2D& image, SemaphoreSubmit wait, uint64_t generation, bool* accepted);
+  void Collect(const std::function<void(uint64_t generation, PackedBoard&& board)>& callback);
+
+  // true if a Request would be accepted right now
+  bool CanRequest() const;
+};
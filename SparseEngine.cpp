@@ -0,0 +1,152 @@
+#include "SparseEngine.h"
+#include "Profile.h"
+
+SparseEngine::SparseEngine(uint32_t width, uint32_t height, Topology topology) : width(width), height(height), topology(topology)
+{
+
+}
+
+template<typename F>
+void SparseEngine::ForEachNeighbour(uint64_t key, F f) const
+{
+  int64_t x = int64_t(key & 0xFFFFFFFF);
+  int64_t y = int64_t(key >> 32);
+  bool wrap = topology == Topology::Torus;
+
+  for (int64_t dy = -1; dy <= 1; dy++)
+  {
+    for (int64_t dx = -1; dx <= 1; dx++)
+    {
+      int64_t nx = x + dx;
+      int64_t ny = y + dy;
+      if ((dx == 0 && dy == 0) || (!wrap && (nx < 0 || ny < 0 || nx >= width || ny >= height)))
+      {
+        continue;
+      }
+
+      f(Key(uint32_t((nx + width) % width), uint32_t((ny + height) % height)));
+    }
+  }
+}
+
+void SparseEngine::Add(uint64_t key)
+{
+  live.insert(key);
+  ForEachNeighbour(key, [this](uint64_t neighbour) { counts[neighbour]++; });
+}
+
+void SparseEngine::Remove(uint64_t key)
+{
+  live.erase(key);
+  ForEachNeighbour(key, [this](uint64_t neighbour)
+  {
+    // a cell without live neighbours is forgotten, so the counts stay as small as the population
+    auto count = counts.find(neighbour);
+    if (--count->second == 0)
+    {
+      counts.erase(count);
+    }
+  });
+}
+
+void SparseEngine::SetCells(const std::vector<Position>& positions)
+{
+  live.clear();
+  counts.clear();
+  changed.clear();
+
+  for (const auto& pos : positions)
+  {
+    uint64_t key = Key(pos.x, pos.y);
+    if (pos.x < width && pos.y < height && live.count(key) == 0)
+    {
+      Add(key);
+      changed.push_back(key);
+    }
+  }
+}
+
+std::vector<Position> SparseEngine::Cells() const
+{
+  std::vector<Position> positions;
+  positions.reserve(live.size());
+
+  for (uint64_t key : live)
+  {
+    positions.push_back({ uint32_t(key & 0xFFFFFFFF), uint32_t(key >> 32) });
+  }
+
+  return positions;
+}
+
+void SparseEngine::ClearCells(const std::vector<Position>& positions)
+{
+  for (const auto& pos : positions)
+  {
+    uint64_t key = Key(pos.x, pos.y);
+    if (live.count(key) != 0)
+    {
+      // its neighbours have to be looked at again in the next step
+      Remove(key);
+      changed.push_back(key);
+    }
+  }
+}
+
+void SparseEngine::SetBoard(const PackedBoard& board)
+{
+  SetCells(UnpackPositions(board));
+}
+
+PackedBoard SparseEngine::GetBoard() const
+{
+  return PackPositions(Cells(), width, height);
+}
+
+void SparseEngine::Step()
+{
+  PROFILE_SCOPE("sparse step");
+
+  // only the changed cells and their neighbours have a different neighbourhood than a generation ago
+  std::unordered_set<uint64_t> candidates;
+  candidates.reserve(changed.size() * 9);
+  for (uint64_t key : changed)
+  {
+    candidates.insert(key);
+    ForEachNeighbour(key, [&](uint64_t neighbour) { candidates.insert(neighbour); });
+  }
+
+  std::vector<uint64_t> born;
+  std::vector<uint64_t> died;
+  for (uint64_t key : candidates)
+  {
+    auto count = counts.find(key);
+    uint8_t neighbours = count != counts.end() ? count->second : 0;
+
+    if (live.count(key) != 0)
+    {
+      if (neighbours != 2 && neighbours != 3)
+      {
+        died.push_back(key);
+      }
+    }
+    else if (neighbours == 3)
+    {
+      born.push_back(key);
+    }
+  }
+
+  // every cell was decided on the old counts, now they may change
+  for (uint64_t key : born)
+  {
+    Add(key);
+  }
+
+  for (uint64_t key : died)
+  {
+    Remove(key);
+  }
+
+  changed = std::move(born);
+  changed.insert(changed.end(), died.begin(), died.end());
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Structs.h"
+#include "Board.h"
+
+// B3/S23 on a set of live cells, for a few patterns on a huge, otherwise empty board.
+// Every cell with live neighbours keeps its neighbour count, and a step only looks at the cells
+// that changed in the step before and at their neighbours, since no other cell can change.
+// Time and memory per generation follow the activity and the population, never the area.
+class SparseEngine
+{
+private:
+  uint32_t width;
+  uint32_t height;
+  Topology topology;
+
+  // y in the high half, x in the low one
+  std::unordered_set<uint64_t> live;
+  std::unordered_map<uint64_t, uint8_t> counts;
+  std::vector<uint64_t> changed;
+
+  static uint64_t Key(uint32_t x, uint32_t y) { return (uint64_t(y) << 32) | x; }
+
+  // the eight neighbours, fewer on the edges of the plane and repeated on a torus narrower than three cells
+  template<typename F>
+  void ForEachNeighbour(uint64_t key, F f) const;
+  void Add(uint64_t key);
+  void Remove(uint64_t key);
+
+public:
+  SparseEngine(uint32_t width, uint32_t height, Topology topology);
+
+  // positions outside the board are ignored
+  void SetCells(const std::vector<Position>& positions);
+  std::vector<Position> Cells() const;
+
+  // kills the given cells, dead ones and positions outside the board are ignored
+  void ClearCells(const std::vector<Position>& positions);
+
+  void SetBoard(const PackedBoard& board);
+  PackedBoard GetBoard() const;
+
+  uint64_t CountCells() const { return live.size(); }
+
+  // cells born or died in the last step
+  size_t Activity() const { return changed.size(); }
+
+  void Step();
+};
@@ -0,0 +1,405 @@
+#include "StripEngine.h"
+#include "GameOfLifeVulkan.h"
+#include "Profile.h"
+
+#include <algorithm>
+#include <cstring>
+
+static VkBufferImageCopy RowCopy(VkDeviceSize bufferOffset, uint32_t row, uint32_t width, uint32_t rows)
+{
+  VkBufferImageCopy region = {};
+  region.bufferOffset = bufferOffset;
+  region.bufferRowLength = 0;
+  region.bufferImageHeight = 0;
+  region.imageOffset = { 0, int32_t(row), 0 };
+  region.imageExtent = { width, rows, 1 };
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = 1;
+
+  return region;
+}
+
+VkResult StripEngine::Create(const std::vector<ComputeContext>& contexts, uint32_t width, uint32_t height, Topology topology)
+{
+  this->width = width;
+  this->height = height;
+  this->topology = topology;
+  parity = 0;
+
+  uint32_t count = uint32_t(contexts.size());
+  if (count == 0 || count > height)
+  {
+    return VK_ERROR_INITIALIZATION_FAILED;
+  }
+
+  VkDeviceSize rowSize = VkDeviceSize(width) * sizeof(uint32_t);
+  uint32_t firstRow = 0;
+
+  strips.resize(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    Strip& strip = strips[i];
+    const ComputeContext& context = contexts[i];
+    VkDevice device = context.device;
+
+    strip.context = &context;
+    strip.firstRow = firstRow;
+    strip.rows = height / count + (i < height % count ? 1 : 0);
+    firstRow += strip.rows;
+
+    for (auto& image : strip.images)
+    {
+      auto imageCreation = CreateImage2D(context.physicalDevice, device, VK_FORMAT_R8G8B8A8_UNORM, width, strip.rows + 2, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+      if (std::holds_alternative<VkResult>(imageCreation))
+      {
+        return std::get<VkResult>(imageCreation);
+      }
+      image = std::get<Image2D>(imageCreation);
+    }
+
+    auto bufferCreation = CreateBuffer(context.physicalDevice, device, 4 * rowSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (std::holds_alternative<VkResult>(bufferCreation))
+    {
+      return std::get<VkResult>(bufferCreation);
+    }
+    strip.halo = std::get<Buffer>(bufferCreation);
+
+    void* haloData;
+    auto result = vkMapMemory(device, strip.halo.memory, 0, 4 * rowSize, 0, &haloData);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    strip.haloData = static_cast<uint8_t*>(haloData);
+    memset(strip.haloData, 0, 4 * rowSize);
+
+    VkDescriptorSetLayoutBinding inBinding = CreateDescriptorSetLayoutBinding(0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+    VkDescriptorSetLayoutBinding outBinding = CreateDescriptorSetLayoutBinding(1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+    auto descriptorSetLayoutCreation = CreateDescriptorSetLayout(device, { inBinding, outBinding });
+    if (std::holds_alternative<VkResult>(descriptorSetLayoutCreation))
+    {
+      return std::get<VkResult>(descriptorSetLayoutCreation);
+    }
+    strip.descriptorSetLayout = std::get<VkDescriptorSetLayout>(descriptorSetLayoutCreation);
+
+    VkPushConstantRange pushConstant = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t) };
+    auto pipelineLayoutCreation = CreatePipelineLayout(device, { strip.descriptorSetLayout }, { pushConstant });
+    if (std::holds_alternative<VkResult>(pipelineLayoutCreation))
+    {
+      return std::get<VkResult>(pipelineLayoutCreation);
+    }
+    strip.pipelineLayout = std::get<VkPipelineLayout>(pipelineLayoutCreation);
+
+    auto pipelineCreation = CreateComputePipeline(device, strip.pipelineLayout, "gol_strip.comp.spv");
+    if (std::holds_alternative<VkResult>(pipelineCreation))
+    {
+      return std::get<VkResult>(pipelineCreation);
+    }
+    strip.pipeline = std::get<VkPipeline>(pipelineCreation);
+
+    result = AllocateCommandBuffer(device, context.commandPool, uint32_t(strip.commands.size()), strip.commands.data());
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    auto fenceCreation = CreateFence(device);
+    if (std::holds_alternative<VkResult>(fenceCreation))
+    {
+      return std::get<VkResult>(fenceCreation);
+    }
+    strip.fence = std::get<VkFence>(fenceCreation);
+
+    result = RunOnce(strip, [&strip](VkCommandBuffer cmd)
+    {
+      for (auto& image : strip.images)
+      {
+        TransitionImageLayout(cmd, image.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+      }
+    });
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    // nothing changes between generations but the direction, so both get recorded once
+    for (uint32_t p = 0; p < 2; p++)
+    {
+      result = RecordStep(strip, p);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+    }
+  }
+
+  return VK_SUCCESS;
+}
+
+void StripEngine::Destroy()
+{
+  for (auto& strip : strips)
+  {
+    VkDevice device = strip.context->device;
+    vkQueueWaitIdle(strip.context->queue);
+
+    vkDestroyFence(device, strip.fence, nullptr);
+    vkFreeCommandBuffers(device, strip.context->commandPool, uint32_t(strip.commands.size()), strip.commands.data());
+    vkDestroyPipeline(device, strip.pipeline, nullptr);
+    vkDestroyPipelineLayout(device, strip.pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, strip.descriptorSetLayout, nullptr);
+
+    vkUnmapMemory(device, strip.halo.memory);
+    FreeBuffer(device, strip.halo);
+
+    for (auto& image : strip.images)
+    {
+      FreeImage(device, image);
+    }
+  }
+
+  strips.clear();
+}
+
+VkResult StripEngine::RecordStep(Strip& strip, uint32_t parity)
+{
+  VkCommandBuffer cmd = strip.commands[parity];
+  const Image2D& in = strip.images[parity];
+  const Image2D& out = strip.images[1 - parity];
+  VkDeviceSize rowSize = VkDeviceSize(width) * sizeof(uint32_t);
+  uint32_t wrap = topology == Topology::Torus ? 1 : 0;
+
+  auto result = BeginCommandBuffer(cmd, 0);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  // the previous step may still read the halo rows' image or write the target
+  GlobalBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  std::array<VkBufferImageCopy, 2> haloIn = { RowCopy(2 * rowSize, 0, width, 1), RowCopy(3 * rowSize, strip.rows + 1, width, 1) };
+  vkCmdCopyBufferToImage(cmd, strip.halo.buffer, in.image, VK_IMAGE_LAYOUT_GENERAL, uint32_t(haloIn.size()), haloIn.data());
+
+  GlobalBarrier(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  std::vector<VkDescriptorImageInfo> inInfos = { { VK_NULL_HANDLE, in.view, VK_IMAGE_LAYOUT_GENERAL } };
+  std::vector<VkDescriptorImageInfo> outInfos = { { VK_NULL_HANDLE, out.view, VK_IMAGE_LAYOUT_GENERAL } };
+
+  std::array<VkWriteDescriptorSet, 2> writeDescriptorSets = {};
+  writeDescriptorSets[0] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, {}, inInfos);
+  writeDescriptorSets[1] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, {}, outInfos);
+
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, strip.pipeline);
+  strip.context->vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, strip.pipelineLayout, 0, uint32_t(writeDescriptorSets.size()), writeDescriptorSets.data());
+  vkCmdPushConstants(cmd, strip.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t), &wrap);
+  vkCmdDispatch(cmd, (width + 15) / 16, (strip.rows + 15) / 16, 1);
+
+  GlobalBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+  // the own first and last row are the neighbours' halo of the next step
+  std::array<VkBufferImageCopy, 2> haloOut = { RowCopy(0, 1, width, 1), RowCopy(rowSize, strip.rows, width, 1) };
+  vkCmdCopyImageToBuffer(cmd, out.image, VK_IMAGE_LAYOUT_GENERAL, strip.halo.buffer, uint32_t(haloOut.size()), haloOut.data());
+
+  GlobalBarrier(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+
+  return vkEndCommandBuffer(cmd);
+}
+
+VkResult StripEngine::RunOnce(const Strip& strip, const std::function<void(VkCommandBuffer)>& record)
+{
+  VkDevice device = strip.context->device;
+  VkCommandBuffer cmd;
+
+  auto result = AllocateCommandBuffer(device, strip.context->commandPool, 1, &cmd);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  BeginCommandBuffer(cmd, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  record(cmd);
+  vkEndCommandBuffer(cmd);
+
+  auto fenceCreation = CreateFence(device);
+  if (std::holds_alternative<VkResult>(fenceCreation))
+  {
+    vkFreeCommandBuffers(device, strip.context->commandPool, 1, &cmd);
+    return std::get<VkResult>(fenceCreation);
+  }
+  VkFence fence = std::get<VkFence>(fenceCreation);
+
+  result = QueueSubmit(strip.context->queue, cmd, {}, {}, fence);
+  if (result == VK_SUCCESS)
+  {
+    result = vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+  }
+
+  vkDestroyFence(device, fence, nullptr);
+  vkFreeCommandBuffers(device, strip.context->commandPool, 1, &cmd);
+  return result;
+}
+
+void StripEngine::ExchangeHalos()
+{
+  PROFILE_SCOPE("exchange halos");
+
+  size_t rowSize = size_t(width) * sizeof(uint32_t);
+  size_t count = strips.size();
+  bool wrap = topology == Topology::Torus;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    // the row above is the last own row of the previous strip, the row below the first of the next one
+    const uint8_t* above = i > 0 ? strips[i - 1].haloData + rowSize : wrap ? strips[count - 1].haloData + rowSize : nullptr;
+    const uint8_t* below = i + 1 < count ? strips[i + 1].haloData : wrap ? strips[0].haloData : nullptr;
+
+    uint8_t* top = strips[i].haloData + 2 * rowSize;
+    uint8_t* bottom = strips[i].haloData + 3 * rowSize;
+
+    if (above)
+    {
+      memcpy(top, above, rowSize);
+    }
+    else
+    {
+      memset(top, 0, rowSize);
+    }
+
+    if (below)
+    {
+      memcpy(bottom, below, rowSize);
+    }
+    else
+    {
+      memset(bottom, 0, rowSize);
+    }
+  }
+}
+
+VkResult StripEngine::SetBoard(const PackedBoard& board)
+{
+  // every strip unpacks only its own rows, the whole board never exists as texels on the host
+  size_t rowSize = size_t(width) * sizeof(uint32_t);
+
+  for (auto& strip : strips)
+  {
+    VkDevice device = strip.context->device;
+    VkDeviceSize size = VkDeviceSize(rowSize) * strip.rows;
+
+    auto bufferCreation = CreateBuffer(strip.context->physicalDevice, device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (std::holds_alternative<VkResult>(bufferCreation))
+    {
+      return std::get<VkResult>(bufferCreation);
+    }
+    Buffer staging = std::get<Buffer>(bufferCreation);
+
+    void* data;
+    vkMapMemory(device, staging.memory, 0, size, 0, &data);
+    UnpackTexelRows(board, strip.firstRow, strip.rows, static_cast<uint32_t*>(data));
+
+    // the own first and last row, as if a step had just written them
+    memcpy(strip.haloData, data, rowSize);
+    memcpy(strip.haloData + rowSize, static_cast<uint8_t*>(data) + (size - rowSize), rowSize);
+    vkUnmapMemory(device, staging.memory);
+
+    const Image2D& image = strip.images[parity];
+    auto result = RunOnce(strip, [&](VkCommandBuffer cmd)
+    {
+      GlobalBarrier(cmd, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+      VkBufferImageCopy region = RowCopy(0, 1, width, strip.rows);
+      vkCmdCopyBufferToImage(cmd, staging.buffer, image.image, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+    });
+
+    FreeBuffer(device, staging);
+
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+  }
+
+  ExchangeHalos();
+  return VK_SUCCESS;
+}
+
+VkResult StripEngine::GetBoard(PackedBoard* board)
+{
+  *board = CreatePackedBoard(width, height);
+  size_t rowSize = size_t(width) * sizeof(uint32_t);
+
+  for (auto& strip : strips)
+  {
+    VkDevice device = strip.context->device;
+    VkDeviceSize size = VkDeviceSize(rowSize) * strip.rows;
+
+    auto bufferCreation = CreateBuffer(strip.context->physicalDevice, device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (std::holds_alternative<VkResult>(bufferCreation))
+    {
+      return std::get<VkResult>(bufferCreation);
+    }
+    Buffer staging = std::get<Buffer>(bufferCreation);
+
+    const Image2D& image = strip.images[parity];
+    auto result = RunOnce(strip, [&](VkCommandBuffer cmd)
+    {
+      GlobalBarrier(cmd, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+      VkBufferImageCopy region = RowCopy(0, 1, width, strip.rows);
+      vkCmdCopyImageToBuffer(cmd, image.image, VK_IMAGE_LAYOUT_GENERAL, staging.buffer, 1, &region);
+
+      GlobalBarrier(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+    });
+
+    if (result == VK_SUCCESS)
+    {
+      void* data;
+      vkMapMemory(device, staging.memory, 0, size, 0, &data);
+      PackedBoard part = PackTexels(static_cast<const uint32_t*>(data), width, strip.rows);
+      vkUnmapMemory(device, staging.memory);
+
+      std::copy(part.words.begin(), part.words.end(), board->words.begin() + size_t(strip.firstRow) * board->wordsPerRow);
+    }
+
+    FreeBuffer(device, staging);
+
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+  }
+
+  return VK_SUCCESS;
+}
+
+VkResult StripEngine::Step()
+{
+  // all devices run at the same time, the host only joins them for the halo exchange
+  for (auto& strip : strips)
+  {
+    auto result = QueueSubmit(strip.context->queue, strip.commands[parity], {}, {}, strip.fence);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+  }
+
+  for (auto& strip : strips)
+  {
+    auto result = vkWaitForFences(strip.context->device, 1, &strip.fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    vkResetFences(strip.context->device, 1, &strip.fence);
+  }
+
+  ExchangeHalos();
+  parity = 1 - parity;
+
+  return VK_SUCCESS;
+}
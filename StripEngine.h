@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Structs.h"
+#include "Board.h"
+
+// Splits the board into horizontal strips, one per compute context, so the board may be
+// larger than the memory of a single device. Every device steps its own strip and the
+// one row halos above and below are exchanged through host visible staging each generation.
+class StripEngine
+{
+private:
+  struct Strip
+  {
+    const ComputeContext* context;
+    uint32_t firstRow;
+    uint32_t rows;
+
+    // rows + 2 rows high, row 0 and rows + 1 are the halo
+    std::array<Image2D, 2> images;
+
+    // four rows: the first and last own row as stepped, then the halo rows for the next step
+    Buffer halo;
+    uint8_t* haloData;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+
+    // prerecorded, one per direction of the ping pong
+    std::array<VkCommandBuffer, 2> commands;
+    VkFence fence;
+  };
+
+  uint32_t width;
+  uint32_t height;
+  Topology topology;
+  uint32_t parity;
+  std::vector<Strip> strips;
+
+  VkResult RecordStep(Strip& strip, uint32_t parity);
+  VkResult RunOnce(const Strip& strip, const std::function<void(VkCommandBuffer)>& record);
+  void ExchangeHalos();
+
+public:
+  StripEngine() = default;
+  ~StripEngine() = default;
+
+  // the contexts have to outlive the engine, strips are spread over them in order
+  VkResult Create(const std::vector<ComputeContext>& contexts, uint32_t width, uint32_t height, Topology topology);
+  void Destroy();
+
+  uint32_t StripCount() const { return uint32_t(strips.size()); }
+  uint32_t StripRows(uint32_t strip) const { return strips[strip].rows; }
+
+  VkResult SetBoard(const PackedBoard& board);
+  VkResult GetBoard(PackedBoard* board);
+
+  // steps every strip and exchanges the halos before returning
+  VkResult Step();
+};
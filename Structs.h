@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <vulkan/vulkan.h>
@@ -10,13 +11,136 @@ struct Position {
   uint32_t x, y;
 };
 
+// layout matches the edits buffer of paint.comp
+struct CellEdit
+{
+  uint32_t x;
+  uint32_t y;
+  uint32_t alive;
+};
+
+// layout matches the stats buffer of gol_batch.comp
+struct BatchStats
+{
+  uint32_t population;
+  // cells that differ from the generation before, 0 once a board has settled into still lifes
+  uint32_t changed;
+};
+
+enum class Topology
+{
+  Plane,
+  Torus
+};
+
+enum class Backend
+{
+  Gpu,
+  Cpu
+};
+
+enum class Kernel
+{
+  Naive,
+  Tiled,
+  Multi
+};
+
+// gol_multi.comp steps a region of MULTI_REGION x MULTI_REGION cells in shared memory for up to
+// MAX_STEPS_PER_DISPATCH generations, and writes back the middle that stayed valid
+constexpr uint32_t MULTI_REGION = 128;
+constexpr uint32_t MAX_STEPS_PER_DISPATCH = 16;
+
+// cells per side of the board written by one workgroup of the kernel
+inline uint32_t KernelTile(Kernel kernel, uint32_t stepsPerDispatch)
+{
+  return kernel == Kernel::Multi ? MULTI_REGION - 2 * stepsPerDispatch : 16;
+}
+
+// layout matches the push constants of gol.comp and gol_tiled.comp, gol_multi.comp only declares the first two;
+// the single generation kernels ignore generations and wrap, heat makes them track the age of every cell
+struct StepPush
+{
+  uint32_t generations;
+  uint32_t wrap;
+  uint32_t heat;
+};
+
+// outer totalistic rule on the square of radius cells around a cell (Larger than Life),
+// written as R5,C0,M1,S34..58,B34..45,NM; B3/S23 is radius 1 without the middle, birth 3..3 and survival 2..3.
+// With more than two states it is a Generations rule: a cell that doesn't survive decays through the states
+// after 1 back to 0 instead of dying at once, and only the cells in state 1 count as neighbours
+struct Rule
+{
+  uint32_t radius;
+  // whether a cell counts as its own neighbour
+  bool middle;
+  uint32_t birthMin;
+  uint32_t birthMax;
+  uint32_t survivalMin;
+  uint32_t survivalMax;
+  uint32_t states;
+};
+
+constexpr Rule LIFE_RULE = { 1, false, 3, 3, 2, 3, 2 };
+
+// every engine can step B3/S23, only some any other rule
+inline bool IsLife(const Rule& rule)
+{
+  uint32_t middle = rule.middle ? 1 : 0;
+  return rule.radius == 1 && rule.birthMin == 3 && rule.birthMax == 3 && rule.survivalMin == 2 + middle && rule.survivalMax == 3 + middle && rule.states == 2;
+}
+
+enum class ExportFormat
+{
+  Png,
+  Y4m,
+  Packed
+};
+
+enum class PresentMode
+{
+  Fifo,
+  Mailbox,
+  Immediate
+};
+
 struct Settings
 {
   uint32_t windowWidth;
   uint32_t windowHeight;
   bool fullScreen;
+  PresentMode presentMode;
+  bool throughput;
   uint32_t imageWidth;
   uint32_t imageHeight;
+  uint32_t runAhead;
+  uint32_t historyBudget;
+  uint32_t keyframeInterval;
+  Topology topology;
+  Backend backend;
+  Kernel kernel;
+  Rule rule;
+  bool heatmap;
+  uint32_t stepsPerDispatch;
+  uint32_t benchmark;
+  uint32_t devices;
+  uint32_t batch;
+  uint32_t generations;
+  uint32_t coordinate;
+  std::string join;
+  uint32_t port;
+  bool gather;
+  bool verify;
+  std::string outOfCorePath;
+  bool sparse;
+  bool census;
+  uint32_t removeEscapees;
+  std::string tracePath;
+  std::string exportPath;
+  ExportFormat exportFormat;
+  double density;
+  uint64_t seed;
   std::vector<Position> positions;
 };
 
@@ -37,6 +161,8 @@ struct PhysicalDevice
   VkPhysicalDeviceFeatures features;
   uint32_t graphicsQueueIndex;
   uint32_t presentationQueueIndex;
+  uint32_t computeQueueIndex;
+  uint32_t transferQueueIndex;
   bool hasAllQueues;
   std::vector<const char*> supportedExtensions;
   bool hasAllRequiredExtensions;
@@ -55,11 +181,22 @@ struct PhysicalDevice
   }
 };
 
+// a device that only computes, without window or swapchain
+struct ComputeContext
+{
+  PhysicalDevice physicalDevice = nullptr;
+  VkDevice device;
+  VkQueue queue;
+  VkCommandPool commandPool;
+  PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR;
+};
+
 struct Swapchain
 {
   VkSwapchainKHR swapchain;
   VkFormat format;
   VkExtent2D extent;
+  VkPresentModeKHR presentMode;
   std::vector<VkImage> images;
   std::vector<VkImageView> imageViews;
 };
@@ -89,6 +226,13 @@ struct Image2D
   uint32_t memoryTypeIndex;
 };
 
+struct SemaphoreSubmit
+{
+  VkSemaphore semaphore;
+  uint64_t value; // ignored for binary semaphores
+  VkPipelineStageFlags stage;
+};
+
 struct Vertex {
   glm::vec3 position;
   glm::vec2 uv;
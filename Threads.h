@@ -0,0 +1,30 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// one thread per core, but no more than there are pieces of work and at least one
+inline uint32_t ThreadCount(uint32_t pieces)
+{
+  return std::max(1u, std::min(std::thread::hardware_concurrency(), pieces));
+}
+
+// work(0) on the calling thread and work(1) to work(threadCount - 1) each on their own, returns once all are done
+template<typename F>
+void ForEachThread(uint32_t threadCount, F work)
+{
+  std::vector<std::thread> threads;
+  for (uint32_t t = 1; t < threadCount; t++)
+  {
+    threads.emplace_back(work, t);
+  }
+
+  work(0);
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock free handover from one producer thread to one consumer thread.
+// The producer fills Back() and publishes it, the consumer picks up the latest published value
+// with Update() and reads Front(). Neither side ever waits: values the consumer was too slow for
+// get overwritten, and the consumer keeps its front until something newer was published.
+template<typename T>
+class TripleBuffer
+{
+private:
+  // index of the middle buffer, plus a flag telling whether it holds something the consumer hasn't seen
+  static constexpr uint8_t FRESH = 4;
+
+  std::array<T, 3> buffers;
+  std::atomic<uint8_t> middle;
+  uint8_t back;
+  uint8_t front;
+
+public:
+  TripleBuffer() : buffers(), middle(1), back(0), front(2)
+  {
+
+  }
+
+  TripleBuffer(const TripleBuffer& buffer) = delete;
+  TripleBuffer& operator=(const TripleBuffer& buffer) = delete;
+
+  // producer side
+  T& Back() { return buffers[back]; }
+
+  void Publish()
+  {
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+  }
+
+  // consumer side, true if Front() changed
+  bool Update()
+  {
+    if (!(middle.load(std::memory_order_relaxed) & FRESH))
+    {
+      return false;
+    }
+
+    front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+    return true;
+  }
+
+  const T& Front() const { return buffers[front]; }
+};
@@ -0,0 +1,101 @@
+#include "Upload.h"
+#include "GameOfLifeVulkan.h"
+#include "Profile.h"
+
+#include <algorithm>
+#include <cstring>
+
+VkResult BoardUploader::Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, uint32_t width, uint32_t height)
+{
+  this->width = width;
+  this->height = height;
+  pending = false;
+
+  auto result = pass.Create(physicalDevice, device, vkCmdPushDescriptorSetKHR, "unpack.comp.spv");
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  PackedBoard layout = CreatePackedBoard(width, height);
+  result = pass.CreateMappedBuffer(layout.words.size() * sizeof(uint64_t), &buffer, &data);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  return pass.AllocateSubmission(&command, &fence);
+}
+
+void BoardUploader::Destroy()
+{
+  vkDestroyFence(pass.device, fence, nullptr);
+  pass.FreeMappedBuffer(buffer);
+  pass.Destroy();
+}
+
+VkResult BoardUploader::Upload(VkQueue computeQueue, const PackedBoard& board, const Image2D& image, const std::vector<SemaphoreSubmit>& waits, SemaphoreSubmit signal)
+{
+  PROFILE_SCOPE("upload");
+
+  if (pending)
+  {
+    auto result = vkWaitForFences(pass.device, 1, &fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+
+    vkResetFences(pass.device, 1, &fence);
+    pending = false;
+  }
+
+  // boards of another size are cut or padded to the image
+  PackedBoard layout = CreatePackedBoard(width, height);
+  if (board.width == width && board.height == height)
+  {
+    memcpy(data, board.words.data(), board.words.size() * sizeof(uint64_t));
+  }
+  else
+  {
+    for (uint32_t y = 0; y < height && y < board.height; y++)
+    {
+      for (uint32_t x = 0; x < width && x < board.width; x++)
+      {
+        SetCell(&layout, x, y, GetCell(board, x, y));
+      }
+    }
+
+    memcpy(data, layout.words.data(), layout.words.size() * sizeof(uint64_t));
+  }
+
+  uint32_t wordsPerRow = 2 * layout.wordsPerRow;
+
+  vkResetCommandBuffer(command, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+  auto result = BeginCommandBuffer(command, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  // the unpack writes every texel, so the old content is dropped once earlier readbacks on this queue are done with it
+  TransitionImageLayout(command, image.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  pass.Bind(command, image, buffer.buffer, wordsPerRow);
+  vkCmdDispatch(command, (width + 15) / 16, (height + 15) / 16, 1);
+
+  result = vkEndCommandBuffer(command);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  result = QueueSubmit(computeQueue, command, waits, { signal }, fence);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  pending = true;
+  return VK_SUCCESS;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Structs.h"
+#include "Board.h"
+#include "GameOfLifeVulkan.h"
+
+// Uploads PackedBoards and expands them to board images on the compute queue,
+// so a seed or a host step only moves one bit per cell over the bus instead of a whole texel.
+class BoardUploader
+{
+private:
+  ComputePass pass;
+
+  uint32_t width;
+  uint32_t height;
+
+  // persistently mapped, reused once the previous upload is done with it
+  Buffer buffer;
+  void* data;
+  VkCommandBuffer command;
+  VkFence fence;
+  bool pending;
+
+public:
+  BoardUploader() = default;
+  ~BoardUploader() = default;
+
+  VkResult Create(const PhysicalDevice& physicalDevice, VkDevice device, PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR, uint32_t width, uint32_t height);
+  void Destroy();
+
+  // waits on the host only for the previous upload, the image is ready once signal is
+  VkResult Upload(VkQueue computeQueue, const PackedBoard& board, const Image2D& image, const std::vector<SemaphoreSubmit>& waits, SemaphoreSubmit signal);
+};
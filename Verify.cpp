@@ -0,0 +1,773 @@
+#include "Verify.h"
+#include "GameOfLifeVulkan.h"
+#include "CpuEngine.h"
+#include "LaneEngine.h"
+#include "SparseEngine.h"
+#include "LtlEngine.h"
+#include "LtlKernel.h"
+#include "GenerationsEngine.h"
+#include "StripEngine.h"
+#include "BatchEngine.h"
+#include "OutOfCore.h"
+#include "Upload.h"
+#include "Readback.h"
+#include "History.h"
+
+#include <array>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+// the rule cell by cell over the whole square, slow but obviously right;
+// a state per cell, the board holds the cells in state 1
+static void ReferenceStep(std::vector<uint8_t>* states, PackedBoard* board, Topology topology, const Rule& rule)
+{
+  std::vector<uint8_t> next(states->size());
+  int32_t width = int32_t(board->width);
+  int32_t height = int32_t(board->height);
+
+  for (int32_t y = 0; y < height; y++)
+  {
+    for (int32_t x = 0; x < width; x++)
+    {
+      int32_t radius = int32_t(rule.radius);
+      uint32_t neighbours = 0;
+      for (int32_t dy = -radius; dy <= radius; dy++)
+      {
+        for (int32_t dx = -radius; dx <= radius; dx++)
+        {
+          int32_t nx = x + dx;
+          int32_t ny = y + dy;
+
+          // a radius beyond the size of the torus reaches around more than once
+          if (topology == Topology::Torus)
+          {
+            nx = (nx % width + width) % width;
+            ny = (ny % height + height) % height;
+          }
+
+          if ((dx != 0 || dy != 0 || rule.middle) && nx >= 0 && ny >= 0 && nx < width && ny < height && (*states)[size_t(ny) * width + nx] == 1)
+          {
+            neighbours++;
+          }
+        }
+      }
+
+      // a cell that doesn't survive decays through the states after 1, with two states it dies at once
+      uint8_t state = (*states)[size_t(y) * width + x];
+      bool survives = neighbours >= rule.survivalMin && neighbours <= rule.survivalMax;
+      bool born = neighbours >= rule.birthMin && neighbours <= rule.birthMax;
+      if (state == 0)
+      {
+        next[size_t(y) * width + x] = born ? 1 : 0;
+      }
+      else
+      {
+        next[size_t(y) * width + x] = state == 1 && survives ? 1 : uint8_t((state + 1) % rule.states);
+      }
+    }
+  }
+
+  *states = std::move(next);
+  *board = CreatePackedBoard(board->width, board->height);
+  for (uint32_t y = 0; y < board->height; y++)
+  {
+    for (uint32_t x = 0; x < board->width; x++)
+    {
+      if ((*states)[size_t(y) * board->width + x] == 1)
+      {
+        SetCell(board, x, y, true);
+      }
+    }
+  }
+}
+
+// FNV-1a over the words, the padding bits are always 0
+static uint64_t HashBoard(const PackedBoard& board)
+{
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (auto word : board.words)
+  {
+    for (uint32_t i = 0; i < 8; i++)
+    {
+      hash ^= (word >> (8 * i)) & 0xFF;
+      hash *= 0x100000001B3ull;
+    }
+  }
+
+  return hash;
+}
+
+bool VerifyEngines(const std::vector<VerifiedEngine>& engines, const PackedBoard& seed, Topology topology, const Rule& rule, uint32_t generations)
+{
+  std::vector<bool> agreeing(engines.size(), true);
+
+  for (size_t i = 0; i < engines.size(); i++)
+  {
+    if (!engines[i].setBoard(seed))
+    {
+      std::cout << engines[i].name << ": could not set the seed" << std::endl;
+      agreeing[i] = false;
+    }
+  }
+
+  PackedBoard reference = seed;
+  std::vector<uint8_t> states(size_t(seed.width) * seed.height);
+  for (uint32_t y = 0; y < seed.height; y++)
+  {
+    for (uint32_t x = 0; x < seed.width; x++)
+    {
+      states[size_t(y) * seed.width + x] = GetCell(seed, x, y) ? 1 : 0;
+    }
+  }
+
+  for (uint32_t generation = 1; generation <= generations; generation++)
+  {
+    ReferenceStep(&states, &reference, topology, rule);
+    uint64_t expected = HashBoard(reference);
+
+    for (size_t i = 0; i < engines.size(); i++)
+    {
+      if (!agreeing[i])
+      {
+        continue;
+      }
+
+      PackedBoard board;
+      if (!engines[i].step() || !engines[i].getBoard(&board))
+      {
+        std::cout << engines[i].name << ": could not step generation " << generation << std::endl;
+        agreeing[i] = false;
+        continue;
+      }
+
+      if (board.width != reference.width || board.height != reference.height)
+      {
+        std::cout << engines[i].name << ": board of " << board.width << "x" << board.height << " instead of " << reference.width << "x" << reference.height << std::endl;
+        agreeing[i] = false;
+        continue;
+      }
+
+      if (HashBoard(board) == expected)
+      {
+        continue;
+      }
+
+      // an engine that diverged once only keeps diverging, it is not stepped any further
+      agreeing[i] = false;
+      bool reported = false;
+      for (uint32_t y = 0; y < reference.height && !reported; y++)
+      {
+        for (uint32_t x = 0; x < reference.width && !reported; x++)
+        {
+          bool alive = GetCell(reference, x, y);
+          if (GetCell(board, x, y) != alive)
+          {
+            std::cout << engines[i].name << ": diverges in generation " << generation << ", first at (" << x << ", " << y << "), expected " << (alive ? "alive" : "dead") <<
+              ", " << CountCells(DiffBoards(board, reference)) << " cells differ" << std::endl;
+            reported = true;
+          }
+        }
+      }
+    }
+  }
+
+  bool all = true;
+  for (size_t i = 0; i < engines.size(); i++)
+  {
+    std::cout << std::left << std::setw(40) << engines[i].name << (agreeing[i] ? "ok" : "FAILED") << std::endl;
+    all = all && agreeing[i];
+  }
+
+  std::cout << generations << " generations, reference hash " << std::hex << HashBoard(reference) << std::dec << ", " << CountCells(reference) << " cells alive" << std::endl;
+  return all;
+}
+
+// the kernels of the interactive path on a compute context, one dispatch per submit
+class KernelEngine
+{
+private:
+  const ComputeContext* context;
+  uint32_t width;
+  uint32_t height;
+
+  std::array<Image2D, 2> images;
+  uint32_t parity;
+
+  Kernel kernel;
+  uint32_t wrap;
+
+  VkSampler sampler;
+  VkDescriptorSetLayout descriptorSetLayout;
+  VkPipelineLayout pipelineLayout;
+  VkPipeline pipeline;
+  VkCommandBuffer command;
+
+  LtlKernel ltl;
+  bool usesLtl;
+
+  // every upload and step signals the next value
+  VkSemaphore timeline;
+  uint64_t value;
+
+  BoardUploader uploader;
+  BoardReadback readback;
+
+public:
+  // with a rule, steps it through the larger than life kernel instead of the kernel's B3/S23
+  VkResult Create(const ComputeContext& context, Kernel kernel, uint32_t width, uint32_t height, Topology topology, const Rule* rule = nullptr);
+  void Destroy();
+
+  VkResult SetBoard(const PackedBoard& board);
+
+  // more than one generation only with the multi kernel
+  VkResult Step(uint32_t generations = 1);
+  VkResult GetBoard(PackedBoard* board);
+};
+
+static std::string KernelShader(Kernel kernel)
+{
+  switch (kernel)
+  {
+  case Kernel::Naive:
+    return "gol.comp.spv";
+  case Kernel::Tiled:
+    return "gol_tiled.comp.spv";
+  case Kernel::Multi:
+    return "gol_multi.comp.spv";
+  }
+
+  return "gol.comp.spv";
+}
+
+VkResult KernelEngine::Create(const ComputeContext& context, Kernel kernel, uint32_t width, uint32_t height, Topology topology, const Rule* rule)
+{
+  this->context = &context;
+  this->width = width;
+  this->height = height;
+  this->kernel = kernel;
+  usesLtl = rule != nullptr;
+  wrap = topology == Topology::Torus ? 1 : 0;
+  parity = 0;
+  value = 0;
+
+  VkDevice device = context.device;
+
+  for (auto& image : images)
+  {
+    auto imageCreation = CreateImage2D(context.physicalDevice, device, VK_FORMAT_R8G8B8A8_UNORM, width, height, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_LAYOUT_UNDEFINED);
+    if (std::holds_alternative<VkResult>(imageCreation))
+    {
+      return std::get<VkResult>(imageCreation);
+    }
+    image = std::get<Image2D>(imageCreation);
+  }
+
+  // the same sampler setup as the interactive path
+  VkSamplerAddressMode addressMode = topology == Topology::Torus ? VK_SAMPLER_ADDRESS_MODE_REPEAT : VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+  auto samplerCreation = CreateSampler(device, VK_FILTER_NEAREST, addressMode, 1, VK_FALSE, VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK);
+  if (std::holds_alternative<VkResult>(samplerCreation))
+  {
+    return std::get<VkResult>(samplerCreation);
+  }
+  sampler = std::get<VkSampler>(samplerCreation);
+
+  VkDescriptorSetLayoutBinding samplerBinding = CreateDescriptorSetLayoutBinding(0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT);
+  VkDescriptorSetLayoutBinding storageBinding = CreateDescriptorSetLayoutBinding(1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+  auto descriptorSetLayoutCreation = CreateDescriptorSetLayout(device, { samplerBinding, storageBinding });
+  if (std::holds_alternative<VkResult>(descriptorSetLayoutCreation))
+  {
+    return std::get<VkResult>(descriptorSetLayoutCreation);
+  }
+  descriptorSetLayout = std::get<VkDescriptorSetLayout>(descriptorSetLayoutCreation);
+
+  VkPushConstantRange pushRange = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(StepPush) };
+  auto pipelineLayoutCreation = CreatePipelineLayout(device, { descriptorSetLayout }, { pushRange });
+  if (std::holds_alternative<VkResult>(pipelineLayoutCreation))
+  {
+    return std::get<VkResult>(pipelineLayoutCreation);
+  }
+  pipelineLayout = std::get<VkPipelineLayout>(pipelineLayoutCreation);
+
+  auto pipelineCreation = CreateComputePipeline(device, pipelineLayout, KernelShader(kernel));
+  if (std::holds_alternative<VkResult>(pipelineCreation))
+  {
+    return std::get<VkResult>(pipelineCreation);
+  }
+  pipeline = std::get<VkPipeline>(pipelineCreation);
+
+  auto result = AllocateCommandBuffer(device, context.commandPool, 1, &command);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  if (usesLtl)
+  {
+    result = ltl.Create(context.physicalDevice, device, context.vkCmdPushDescriptorSetKHR, width, height, *rule);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+  }
+
+  auto timelineCreation = CreateTimelineSemaphore(device, 0);
+  if (std::holds_alternative<VkResult>(timelineCreation))
+  {
+    return std::get<VkResult>(timelineCreation);
+  }
+  timeline = std::get<VkSemaphore>(timelineCreation);
+
+  result = uploader.Create(context.physicalDevice, device, context.vkCmdPushDescriptorSetKHR, width, height);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  return readback.Create(context.physicalDevice, device, context.vkCmdPushDescriptorSetKHR, width, height, 1);
+}
+
+void KernelEngine::Destroy()
+{
+  VkDevice device = context->device;
+  vkDeviceWaitIdle(device);
+
+  readback.Destroy();
+  uploader.Destroy();
+
+  if (usesLtl)
+  {
+    ltl.Destroy();
+  }
+
+  vkDestroySemaphore(device, timeline, nullptr);
+  vkFreeCommandBuffers(device, context->commandPool, 1, &command);
+  vkDestroyPipeline(device, pipeline, nullptr);
+  vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+  vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+  vkDestroySampler(device, sampler, nullptr);
+
+  for (auto& image : images)
+  {
+    FreeImage(device, image);
+  }
+}
+
+VkResult KernelEngine::SetBoard(const PackedBoard& board)
+{
+  value++;
+  return uploader.Upload(context->queue, board, images[parity], { { timeline, value - 1, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT } }, { timeline, value, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT });
+}
+
+VkResult KernelEngine::Step(uint32_t generations)
+{
+  // the command buffer is reused, so the previous step has to be done with it
+  auto result = WaitTimelineSemaphore(context->device, timeline, value, UINT64_MAX);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  const Image2D& src = images[parity];
+  const Image2D& dst = images[parity ^ 1];
+
+  // the write descriptor sets only point into these
+  std::vector<VkDescriptorImageInfo> samplerInfos = { { sampler, src.view, VK_IMAGE_LAYOUT_GENERAL } };
+  std::vector<VkDescriptorImageInfo> storageInfos = { { VK_NULL_HANDLE, dst.view, VK_IMAGE_LAYOUT_GENERAL } };
+
+  std::array<VkWriteDescriptorSet, 2> writeDescriptorSets = {};
+  writeDescriptorSets[0] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, {}, samplerInfos);
+  writeDescriptorSets[1] = CreateWriteDescriptorSet(VK_NULL_HANDLE, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, {}, storageInfos);
+
+  vkResetCommandBuffer(command, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+  result = BeginCommandBuffer(command, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  TransitionImageLayout(command, dst.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  if (usesLtl)
+  {
+    ltl.Record(command, sampler, src.view, dst.view);
+  }
+  else
+  {
+    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    StepPush push = { generations, wrap };
+    uint32_t tile = KernelTile(kernel, generations);
+
+    context->vkCmdPushDescriptorSetKHR(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, uint32_t(writeDescriptorSets.size()), writeDescriptorSets.data());
+    vkCmdPushConstants(command, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+    vkCmdDispatch(command, (width + tile - 1) / tile, (height + tile - 1) / tile, 1);
+  }
+
+  result = vkEndCommandBuffer(command);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  result = QueueSubmit(context->queue, command, { { timeline, value, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT } }, { { timeline, value + 1, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT } });
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  value++;
+  parity ^= 1;
+  return VK_SUCCESS;
+}
+
+VkResult KernelEngine::GetBoard(PackedBoard* board)
+{
+  bool accepted;
+  auto result = readback.Request(context->queue, images[parity], { timeline, value, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT }, value, &accepted);
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(QueueMutex(context->queue));
+    result = vkQueueWaitIdle(context->queue);
+  }
+  if (result != VK_SUCCESS)
+  {
+    return result;
+  }
+
+  bool collected = false;
+  readback.Collect([board, &collected](uint64_t generation, PackedBoard&& packed)
+  {
+    *board = std::move(packed);
+    collected = true;
+  });
+
+  return collected ? VK_SUCCESS : VK_ERROR_UNKNOWN;
+}
+
+bool RunVerification(const Settings& settings, const PackedBoard& seed)
+{
+  uint32_t width = settings.imageWidth;
+  uint32_t height = settings.imageHeight;
+  Topology topology = settings.topology;
+
+  // life is just another rule to the larger than life and generations engines, every other engine only knows life;
+  // the larger than life engines only know two states, the generations engine only radius 1
+  bool life = IsLife(settings.rule);
+  bool ltl = settings.rule.states == 2;
+  std::vector<VerifiedEngine> engines;
+
+  LtlEngine ltlEngine(width, height, topology, ltl ? settings.rule : LIFE_RULE);
+  if (ltl)
+  {
+    engines.push_back({ "cpu ltl",
+      [&](const PackedBoard& board) { ltlEngine.SetBoard(board); return true; },
+      [&]() { ltlEngine.Step(); return true; },
+      [&](PackedBoard* board) { *board = ltlEngine.GetBoard(); return true; } });
+  }
+
+  GenerationsEngine generationsEngine(width, height, topology, settings.rule.radius == 1 ? settings.rule : LIFE_RULE);
+  if (settings.rule.radius == 1)
+  {
+    engines.push_back({ "cpu generations",
+      [&](const PackedBoard& board) { generationsEngine.SetBoard(board); return true; },
+      [&]() { generationsEngine.Step(); return true; },
+      [&](PackedBoard* board) { *board = generationsEngine.GetBoard(); return true; } });
+  }
+
+  CpuEngine cpuEngine(width, height, topology);
+  CpuEngine blockedEngine(width, height, topology);
+  CpuEngine blockedAnchor(width, height, topology);
+  LaneEngine laneEngine(width, height, life ? LaneEngine::LANES_PER_WORD + 2 : 0, topology);
+  SparseEngine sparseEngine(width, height, topology);
+  OutOfCoreBoard outOfCore;
+  OutOfCoreBoard blockedOutOfCore;
+  PackedBoard outOfCoreAnchor;
+  uint32_t blockedGenerations = 0;
+  uint32_t outOfCoreGenerations = 0;
+
+  // bands of a seventh of the board, two to a batch, so the rows handed between bands, between batches
+  // and around the torus all get stepped, and a shorter last band with most heights
+  const std::string outOfCorePath = "verify_out_of_core.bin";
+  const std::string blockedOutOfCorePath = "verify_out_of_core_blocked.bin";
+  size_t outOfCoreBandBytes = size_t((width + 63) / 64) * sizeof(uint64_t) * std::max(1u, height / 7);
+
+  if (life)
+  {
+    engines.push_back({ "cpu",
+      [&](const PackedBoard& board) { cpuEngine.SetBoard(board); return true; },
+      [&]() { cpuEngine.Step(); return true; },
+      [&](PackedBoard* board) { *board = cpuEngine.GetBoard(); return true; } });
+
+    // every generation in between is stepped from the last full block in a single shorter block,
+    // so the trapezoids of every block size get compared
+    engines.push_back({ "cpu blocked",
+      [&](const PackedBoard& board) { blockedAnchor.SetBoard(board); blockedGenerations = 0; return true; },
+      [&]()
+      {
+        blockedGenerations++;
+        blockedEngine = blockedAnchor;
+        blockedEngine.StepBlocked(blockedGenerations);
+        if (blockedGenerations == CpuEngine::TEMPORAL_BLOCK)
+        {
+          blockedAnchor = blockedEngine;
+          blockedGenerations = 0;
+        }
+        return true;
+      },
+      [&](PackedBoard* board) { *board = blockedEngine.GetBoard(); return true; } });
+
+    // the seed in a lane of the second word, between soups in the lanes around it
+    engines.push_back({ "cpu lanes",
+      [&](const PackedBoard& board)
+      {
+        for (uint32_t i = 0; i < laneEngine.Count(); i++)
+        {
+          laneEngine.SetBoard(i, i == LaneEngine::LANES_PER_WORD ? board : RandomBoard(width, height, 0.5, i));
+        }
+        return true;
+      },
+      [&]() { laneEngine.Step(); return true; },
+      [&](PackedBoard* board) { *board = laneEngine.GetBoard(LaneEngine::LANES_PER_WORD); return true; } });
+
+    engines.push_back({ "cpu sparse",
+      [&](const PackedBoard& board) { sparseEngine.SetBoard(board); return true; },
+      [&]() { sparseEngine.Step(); return true; },
+      [&](PackedBoard* board) { *board = sparseEngine.GetBoard(); return true; } });
+
+    engines.push_back({ "cpu out of core",
+      [&](const PackedBoard& board) { return outOfCore.Create(outOfCorePath, width, height, 0.0, 0, UnpackPositions(board), topology, outOfCoreBandBytes, 2); },
+      [&]() { return outOfCore.Step(); },
+      [&](PackedBoard* board) { return outOfCore.GetBoard(board); } });
+
+    // like the blocked cpu engine, every pass over the file is as long as the generations since the last full block
+    engines.push_back({ "cpu out of core blocked",
+      [&](const PackedBoard& board) { outOfCoreAnchor = board; outOfCoreGenerations = 0; return true; },
+      [&]()
+      {
+        outOfCoreGenerations++;
+        if (!blockedOutOfCore.Create(blockedOutOfCorePath, width, height, 0.0, 0, UnpackPositions(outOfCoreAnchor), topology, outOfCoreBandBytes, 2) ||
+          !blockedOutOfCore.Step(outOfCoreGenerations))
+        {
+          return false;
+        }
+        if (outOfCoreGenerations == CpuEngine::TEMPORAL_BLOCK)
+        {
+          outOfCoreGenerations = 0;
+          return blockedOutOfCore.GetBoard(&outOfCoreAnchor);
+        }
+        return true;
+      },
+      [&](PackedBoard* board) { return blockedOutOfCore.GetBoard(board); } });
+  }
+
+  // the gpu engines are optional, without vulkan only the cpu gets verified
+  VkInstance instance = VK_NULL_HANDLE;
+  std::vector<ComputeContext> contexts;
+
+  auto layers = CheckInstanceLayers({ "VK_LAYER_LUNARG_standard_validation" });
+  if (CheckVulkanVersion(VK_API_VERSION_1_2) && std::holds_alternative<std::vector<const char*>>(layers))
+  {
+    auto creation = CreateInstance("Game of Life", VK_MAKE_VERSION(0, 1, 0), VK_API_VERSION_1_2, std::get<std::vector<const char*>>(layers), {});
+    if (std::holds_alternative<VkInstance>(creation))
+    {
+      instance = std::get<VkInstance>(creation);
+    }
+  }
+
+  if (instance != VK_NULL_HANDLE)
+  {
+    auto physicalDeviceSelection = GetComputePhysicalDevices(instance, { VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME });
+    if (std::holds_alternative<std::vector<PhysicalDevice>>(physicalDeviceSelection))
+    {
+      for (auto& physicalDevice : std::get<std::vector<PhysicalDevice>>(physicalDeviceSelection))
+      {
+        auto contextCreation = CreateComputeContext(physicalDevice);
+        if (std::holds_alternative<ComputeContext>(contextCreation))
+        {
+          contexts.push_back(std::get<ComputeContext>(contextCreation));
+        }
+      }
+    }
+  }
+
+  if (contexts.empty())
+  {
+    std::cout << "no compute device found, only the cpu engine gets verified" << std::endl;
+  }
+
+  // contexts doesn't change from here on, the engines keep pointers into it
+  std::vector<std::unique_ptr<KernelEngine>> kernels;
+  for (auto& context : contexts)
+  {
+    if (!ltl)
+    {
+      continue;
+    }
+
+    std::string ltlName = std::string(context.physicalDevice.properties.deviceName) + " ltl";
+
+    auto ltlKernel = std::make_unique<KernelEngine>();
+    auto ltlResult = ltlKernel->Create(context, Kernel::Naive, width, height, topology, &settings.rule);
+    if (ltlResult != VK_SUCCESS)
+    {
+      std::cout << ltlName << ": could not create: VkResult = " << VkResultToString(ltlResult) << std::endl;
+      return false;
+    }
+
+    KernelEngine* l = ltlKernel.get();
+    engines.push_back({ ltlName,
+      [l](const PackedBoard& board) { return l->SetBoard(board) == VK_SUCCESS; },
+      [l]() { return l->Step() == VK_SUCCESS; },
+      [l](PackedBoard* board) { return l->GetBoard(board) == VK_SUCCESS; } });
+    kernels.push_back(std::move(ltlKernel));
+
+    if (!life)
+    {
+      continue;
+    }
+
+    for (auto kernel : { std::make_pair("naive", Kernel::Naive), std::make_pair("tiled", Kernel::Tiled), std::make_pair("multi", Kernel::Multi) })
+    {
+      std::string name = std::string(context.physicalDevice.properties.deviceName) + " " + kernel.first;
+
+      auto engine = std::make_unique<KernelEngine>();
+      auto result = engine->Create(context, kernel.second, width, height, topology);
+      if (result != VK_SUCCESS)
+      {
+        std::cout << name << ": could not create: VkResult = " << VkResultToString(result) << std::endl;
+        return false;
+      }
+
+      KernelEngine* e = engine.get();
+      if (kernel.second != Kernel::Multi)
+      {
+        engines.push_back({ name,
+          [e](const PackedBoard& board) { return e->SetBoard(board) == VK_SUCCESS; },
+          [e]() { return e->Step() == VK_SUCCESS; },
+          [e](PackedBoard* board) { return e->GetBoard(board) == VK_SUCCESS; } });
+      }
+      else
+      {
+        // like the blocked cpu engine, every generation is a single dispatch from the last full one,
+        // which is kept on the host and uploaded again
+        auto anchor = std::make_shared<std::pair<PackedBoard, uint32_t>>();
+        engines.push_back({ name,
+          [e, anchor](const PackedBoard& board) { *anchor = { board, 0 }; return e->SetBoard(board) == VK_SUCCESS; },
+          [e, anchor]()
+          {
+            anchor->second++;
+            if (e->SetBoard(anchor->first) != VK_SUCCESS || e->Step(anchor->second) != VK_SUCCESS)
+            {
+              return false;
+            }
+
+            if (anchor->second == MAX_STEPS_PER_DISPATCH)
+            {
+              anchor->second = 0;
+              return e->GetBoard(&anchor->first) == VK_SUCCESS;
+            }
+            return true;
+          },
+          [e](PackedBoard* board) { return e->GetBoard(board) == VK_SUCCESS; } });
+      }
+      kernels.push_back(std::move(engine));
+    }
+  }
+
+  // at least two strips, so the halo exchange is part of it even with a single device
+  std::vector<ComputeContext> stripContexts = contexts;
+  if (stripContexts.size() == 1)
+  {
+    stripContexts.push_back(contexts[0]);
+  }
+
+  StripEngine strips;
+  bool hasStrips = life && !stripContexts.empty() && stripContexts.size() <= height;
+  if (hasStrips)
+  {
+    auto result = strips.Create(stripContexts, width, height, topology);
+    if (result != VK_SUCCESS)
+    {
+      std::cout << "strips: could not create: VkResult = " << VkResultToString(result) << std::endl;
+      return false;
+    }
+
+    engines.push_back({ std::to_string(strips.StripCount()) + " strips",
+      [&](const PackedBoard& board) { return strips.SetBoard(board) == VK_SUCCESS; },
+      [&]() { return strips.Step() == VK_SUCCESS; },
+      [&](PackedBoard* board) { return strips.GetBoard(board) == VK_SUCCESS; } });
+  }
+
+  // the seed between two other soups, so a board bleeding into its neighbours in the buffer shows up;
+  // the population gathered on the device has to match the board read back
+  BatchEngine batch;
+  bool hasBatch = life && !contexts.empty();
+  if (hasBatch)
+  {
+    auto result = batch.Create(contexts[0], width, height, 3, topology);
+    if (result != VK_SUCCESS)
+    {
+      std::cout << "batch: could not create: VkResult = " << VkResultToString(result) << std::endl;
+      return false;
+    }
+
+    engines.push_back({ "batch",
+      [&](const PackedBoard& board) { return batch.SetBoards({ RandomBoard(width, height, 0.5, 1), board, RandomBoard(width, height, 0.5, 2) }) == VK_SUCCESS; },
+      [&]() { return batch.Step(1) == VK_SUCCESS; },
+      [&](PackedBoard* board)
+      {
+        if (batch.GetBoard(1, board) != VK_SUCCESS)
+        {
+          return false;
+        }
+
+        if (batch.Stats(1).population != CountCells(*board))
+        {
+          std::cout << "batch: gathered a population of " << batch.Stats(1).population << " instead of " << CountCells(*board) << std::endl;
+          return false;
+        }
+        return true;
+      } });
+  }
+
+  bool agreed = VerifyEngines(engines, seed, topology, settings.rule, settings.generations);
+
+  if (life)
+  {
+    std::remove(outOfCorePath.c_str());
+    std::remove(blockedOutOfCorePath.c_str());
+  }
+
+  if (hasBatch)
+  {
+    batch.Destroy();
+  }
+
+  if (hasStrips)
+  {
+    strips.Destroy();
+  }
+
+  for (auto& kernel : kernels)
+  {
+    kernel->Destroy();
+  }
+
+  for (auto& context : contexts)
+  {
+    DestroyComputeContext(context);
+  }
+
+  if (instance != VK_NULL_HANDLE)
+  {
+    vkDestroyInstance(instance, nullptr);
+  }
+
+  return agreed;
+}
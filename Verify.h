@@ -0,0 +1,27 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Structs.h"
+#include "Board.h"
+
+// One way of stepping a board, checked generation by generation against a plain per cell reference.
+// Any engine can be gated on the reference by wrapping it in one of these.
+struct VerifiedEngine
+{
+  std::string name;
+  std::function<bool(const PackedBoard& board)> setBoard;
+  std::function<bool()> step;
+  std::function<bool(PackedBoard* board)> getBoard;
+};
+
+// steps every engine from the seed and compares board hashes against the reference after every generation,
+// the first divergence of an engine is reported with its generation and cell, true if all engines agreed throughout
+bool VerifyEngines(const std::vector<VerifiedEngine>& engines, const PackedBoard& seed, Topology topology, const Rule& rule, uint32_t generations);
+
+// runs the seed on the cpu engines (the out of core ones through files in the working directory), every kernel on every compute device (software implementations included)
+// the strips spread over all of them and a batch of boards on the first device;
+// a rule other than life only on the larger than life engine and kernels and the generations engine
+bool RunVerification(const Settings& settings, const PackedBoard& seed);
@@ -2,6 +2,12 @@
 #extension GL_ARB_separate_shader_objects : enable
 
 layout (set = 0, binding = 1) uniform sampler2D samplerColorMap;
+layout (set = 0, binding = 2) uniform sampler2D samplerPalette;
+
+layout(push_constant) uniform Push
+{
+	uint heat;
+} push;
 
 layout (location = 0) in vec2 inUV;
 
@@ -9,5 +15,11 @@ layout (location = 0) out vec4 outFragColor;
 
 void main() 
 {
-	outFragColor = texture(samplerColorMap, inUV);
+	vec4 color = texture(samplerColorMap, inUV);
+
+	// live cells through the palette by their age, the step kernels keep 255 minus it in red
+	if(push.heat != 0u && color.a >= 0.25)
+		color = texture(samplerPalette, vec2((255.0 - round(color.r * 255.0) + 0.5) / 256.0, 0.5));
+
+	outFragColor = color;
 }
\ No newline at end of file